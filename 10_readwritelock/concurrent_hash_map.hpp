@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 分片的并发哈希表: 整个表分成若干个分片, 每个分片是一个 std::unordered_map 加一把读写锁.
+ *
+ * main.cpp 中的做法是一把 std::shared_mutex 保护整个容器. 即使全是读操作, 每次加共享锁也要原子地修改
+ * 锁内部的读者计数, 所有线程都在写同一条缓存行, 线程越多越慢; 有写操作时, 所有读线程都要等待.
+ * 按 key 的哈希值分片之后:
+ *   - 不同分片的操作完全独立, 锁的竞争和缓存行的争用都分散到各个分片;
+ *   - 每个分片单独占用缓存行(alignas(64)), 相邻分片的锁不会互相影响(伪共享);
+ *   - 写操作只阻塞同一个分片上的读操作.
+ * find() 返回值的拷贝(std::optional<T>), 不会返回引用, 因为锁释放之后元素可能被其他线程修改或删除;
+ * 不想拷贝时使用 visit(key, f), f 在持有共享锁期间被调用.
+ * snapshot() / for_each() 按固定顺序给所有分片加共享锁, 得到的是某一时刻的一致视图(不会看到一半的修改).
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class concurrent_hash_map
+{
+ public:
+  /// @brief shard_count 会向上取整为 2 的幂, 默认是硬件线程数的 4 倍(至少 16)
+  explicit concurrent_hash_map(std::size_t shard_count = defaultShardCount())
+  {
+    std::size_t n = 1;
+    while (n < shard_count) n *= 2;
+    shard_count_ = n;
+    shards_ = std::make_unique<Shard[]>(n);
+  }
+
+  concurrent_hash_map(const concurrent_hash_map &) = delete;
+  concurrent_hash_map &operator=(const concurrent_hash_map &) = delete;
+
+  /// @brief key 不存在时插入, 存在时赋值; 返回是否插入了新元素
+  template <typename M>
+  bool insert_or_assign(const Key &key, M &&value)
+  {
+    Shard &shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.insert_or_assign(key, std::forward<M>(value)).second;
+  }
+
+  /// @brief key 不存在时插入, 已存在时不修改; 返回是否插入了新元素
+  template <typename... Args>
+  bool try_emplace(const Key &key, Args &&...args)
+  {
+    Shard &shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.try_emplace(key, std::forward<Args>(args)...).second;
+  }
+
+  /// @brief 返回 value 的拷贝
+  std::optional<T> find(const Key &key) const
+  {
+    const Shard &shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) return std::nullopt;
+    return it->second;
+  }
+
+  /// @brief key 存在时在共享锁内调用 f(const T &), 返回 key 是否存在. f 中不能再访问本容器
+  template <typename F>
+  bool visit(const Key &key, F &&f) const
+  {
+    const Shard &shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) return false;
+    std::forward<F>(f)(it->second);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(const Key &key) const
+  {
+    const Shard &shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.find(key) != shard.map.end();
+  }
+
+  bool erase(const Key &key)
+  {
+    Shard &shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.erase(key) != 0;
+  }
+
+  /// @brief 元素个数(一致的计数, 会短暂地给所有分片加共享锁)
+  [[nodiscard]] std::size_t size() const
+  {
+    std::size_t n = 0;
+    for_each_shard([&](const auto &map) { n += map.size(); });
+    return n;
+  }
+
+  /// @brief 在所有分片的共享锁内遍历每个元素 f(const Key &, const T &), 期间写操作会被阻塞
+  template <typename F>
+  void for_each(F &&f) const
+  {
+    for_each_shard(
+      [&](const auto &map)
+      {
+        for (const auto &[key, value] : map) f(key, value);
+      });
+  }
+
+  /// @brief 某一时刻的一致快照, 返回之后可以在不持有锁的情况下遍历(支持结构化绑定)
+  [[nodiscard]] std::vector<std::pair<Key, T>> snapshot() const
+  {
+    std::vector<std::pair<Key, T>> out;
+    for_each_shard([&](const auto &map) { out.insert(out.end(), map.begin(), map.end()); });
+    return out;
+  }
+
+  void clear()
+  {
+    for (std::size_t i = 0; i < shard_count_; ++i)
+    {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+      shards_[i].map.clear();
+    }
+  }
+
+  [[nodiscard]] std::size_t shard_count() const noexcept
+  {
+    return shard_count_;
+  }
+
+ private:
+  struct alignas(64) Shard
+  {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<Key, T, Hash, KeyEqual> map;
+  };
+
+  static std::size_t defaultShardCount()
+  {
+    const std::size_t threads = std::thread::hardware_concurrency();
+    return threads * 4 < 16 ? 16 : threads * 4;
+  }
+
+  /// @brief 哈希值打散之后取高位选择分片: unordered_map 内部用低位选择桶, 两者互不影响
+  std::size_t shardIndex(const Key &key) const
+  {
+    const std::uint64_t h = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h >> 32) & (shard_count_ - 1);
+  }
+
+  Shard &shardFor(const Key &key)
+  {
+    return shards_[shardIndex(key)];
+  }
+  const Shard &shardFor(const Key &key) const
+  {
+    return shards_[shardIndex(key)];
+  }
+
+  /// @brief 按分片顺序加共享锁(固定顺序, 不会死锁), 全部加锁之后再依次调用 f
+  template <typename F>
+  void for_each_shard(F &&f) const
+  {
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    locks.reserve(shard_count_);
+    for (std::size_t i = 0; i < shard_count_; ++i) locks.emplace_back(shards_[i].mutex);
+    for (std::size_t i = 0; i < shard_count_; ++i) f(shards_[i].map);
+  }
+
+  std::unique_ptr<Shard[]> shards_;
+  std::size_t shard_count_ = 0;
+  Hash hash_;
+};
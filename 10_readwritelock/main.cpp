@@ -4,6 +4,15 @@
 #include <vector>
 #include <utility>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <optional>
+
+#include "bench.hpp"
+#include "concurrent_hash_map.hpp"
 
 #include <fmt/core.h>
 #include <fmt/ranges.h>
@@ -45,8 +54,194 @@ void writeData(int value)
   fmt::print("[{:#06x}]: write value {}\n", tid(), value);
 }
 
+/// @brief 对照组: 一把读写锁保护整个 unordered_map, 接口与 concurrent_hash_map 相同
+template <typename Key, typename T>
+class locked_hash_map
+{
+ public:
+  bool insert_or_assign(const Key &key, const T &value)
+  {
+    std::unique_lock<std::shared_mutex> locker(mtx_);
+    return map_.insert_or_assign(key, value).second;
+  }
+  std::optional<T> find(const Key &key) const
+  {
+    std::shared_lock<std::shared_mutex> locker(mtx_);
+    auto it = map_.find(key);
+    if (it == map_.end()) return std::nullopt;
+    return it->second;
+  }
+  bool erase(const Key &key)
+  {
+    std::unique_lock<std::shared_mutex> locker(mtx_);
+    return map_.erase(key) != 0;
+  }
+
+ private:
+  mutable std::shared_mutex mtx_;
+  std::unordered_map<Key, T> map_;
+};
+
+void testConcurrentHashMap()
+{
+  fmt::print("---- concurrent_hash_map test ----\n");
+  concurrent_hash_map<int, int> map;
+  int errors = 0;
+  errors += map.insert_or_assign(1, 10) ? 0 : 1;
+  errors += map.insert_or_assign(1, 11) ? 1 : 0;  // 已存在, 只赋值
+  errors += map.find(1) == 11 ? 0 : 1;
+  errors += map.find(2).has_value() ? 1 : 0;
+  errors += map.erase(1) ? 0 : 1;
+  errors += map.erase(1) ? 1 : 0;
+
+  // 每个线程只写自己的 key 区间: 写入一遍, 删除奇数, 偶数再改写一遍
+  constexpr int threadCount = 4;
+  constexpr int perThread = 20000;
+  std::atomic<bool> stop{false};
+  std::atomic<int> badSnapshots{0};
+
+  std::thread checker(
+    [&]
+    {
+      // 并发地取快照: 每个 value 必须是 key 或 key * 2(一致的视图中不会有其他值)
+      while (!stop.load(std::memory_order_relaxed))
+      {
+        for (const auto &[key, value] : map.snapshot())
+        {
+          if (value != key && value != key * 2) badSnapshots.fetch_add(1);
+        }
+      }
+    });
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    workers.emplace_back(
+      [&map, t]
+      {
+        const int base = t * perThread;
+        for (int i = base; i < base + perThread; ++i) map.insert_or_assign(i, i);
+        for (int i = base + 1; i < base + perThread; i += 2) map.erase(i);
+        for (int i = base; i < base + perThread; i += 2) map.insert_or_assign(i, i * 2);
+      });
+  }
+  for (auto &th : workers) th.join();
+  stop = true;
+  checker.join();
+
+  errors += map.size() == threadCount * perThread / 2 ? 0 : 1;
+  int visited = 0;
+  map.for_each(
+    [&](int key, int value)
+    {
+      ++visited;
+      if (key % 2 != 0 || value != key * 2) ++errors;
+    });
+  errors += visited == threadCount * perThread / 2 ? 0 : 1;
+
+  // 跨分片的一致性: ringWriter 把第 step 步写到 key = step % kRing, 任意时刻 kRing 个 value 正好是最近的 kRing 个步数
+  // (max - min == kRing - 1). 快照如果在不同时刻读取不同的分片, 就会同时看到较旧和较新的步数, max - min 变大
+  constexpr int kRing = 8;  // key 0..7 分布在不同的分片上
+  constexpr int kRingSnapshots = 20000;
+  concurrent_hash_map<int, std::int64_t> ring;
+  for (int key = 0; key < kRing; ++key) ring.insert_or_assign(key, std::int64_t{key});
+  std::atomic<bool> ringDone{false};
+  std::thread ringWriter(
+    [&]
+    {
+      for (std::int64_t step = kRing; !ringDone.load(std::memory_order_relaxed); ++step)
+        ring.insert_or_assign(static_cast<int>(step % kRing), step);
+    });
+  int badRingSnapshots = 0;
+  for (int i = 0; i < kRingSnapshots; ++i)
+  {
+    const auto view = ring.snapshot();
+    const auto [lo, hi] = std::minmax_element(view.begin(), view.end(),
+                                              [](const auto &a, const auto &b) { return a.second < b.second; });
+    if (view.size() != kRing || hi->second - lo->second != kRing - 1) ++badRingSnapshots;
+  }
+  ringDone = true;
+  ringWriter.join();
+  errors += badSnapshots.load() + badRingSnapshots;
+  fmt::print("shards: {}, size: {}, bad snapshot values: {}, inconsistent ring snapshots: {}, errors: {}\n",
+             map.shard_count(), map.size(), badSnapshots.load(), badRingSnapshots, errors);
+}
+
+/// @brief threadCount 个线程同时执行 opsPerThread 次操作, 其中 writePercent% 是写(一半 insert_or_assign, 一半 erase),
+/// 其余是 find; 返回每秒完成的操作数
+template <typename Map>
+double runMix(Map &map, int threadCount, int writePercent, int keyRange, int opsPerThread)
+{
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back(
+      [&, t]
+      {
+        std::mt19937 rng(static_cast<unsigned>(t) * 7919 + 1);
+        std::uniform_int_distribution<int> keyDist(0, keyRange - 1);
+        std::uniform_int_distribution<int> opDist(0, 199);
+        std::int64_t found = 0;
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        for (int i = 0; i < opsPerThread; ++i)
+        {
+          const int key = keyDist(rng);
+          const int op = opDist(rng);
+          if (op >= writePercent * 2)
+            found += map.find(key).has_value() ? 1 : 0;
+          else if (op % 2 == 0)
+            map.insert_or_assign(key, std::int64_t{key});
+          else
+            map.erase(key);
+        }
+        bench::doNotOptimize(found);
+      });
+  }
+  while (ready.load() != threadCount) std::this_thread::yield();
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &th : threads) th.join();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(threadCount) * opsPerThread / elapsed.count();
+}
+
+void benchConcurrentHashMap()
+{
+  constexpr int keyRange = 1 << 16;  // 预先写入一半的 key, 读操作大约一半命中
+  constexpr int opsPerThread = 200000;
+  const int maxThreads = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+  fmt::print("---- concurrent map benchmark ({} keys, {} ops/thread, Mops/s) ----\n", keyRange, opsPerThread);
+  fmt::print("  {:>7} {:>6} {:>22} {:>22}\n", "threads", "mix", "shared_mutex+map", "concurrent_hash_map");
+  // 1, 2, 4, ... 翻倍, 最后一步总是 maxThreads(硬件线程数不是 2 的幂时也能测到)
+  std::vector<int> threadCounts;
+  for (int threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+  threadCounts.push_back(maxThreads);
+  for (int writePercent : {10, 50})
+  {
+    for (int threads : threadCounts)
+    {
+      locked_hash_map<int, std::int64_t> locked;
+      concurrent_hash_map<int, std::int64_t> sharded;
+      for (int key = 0; key < keyRange; key += 2)
+      {
+        locked.insert_or_assign(key, key);
+        sharded.insert_or_assign(key, key);
+      }
+      const double lockedOps = runMix(locked, threads, writePercent, keyRange, opsPerThread);
+      const double shardedOps = runMix(sharded, threads, writePercent, keyRange, opsPerThread);
+      fmt::print("  {:>7} {:>3}/{:<2} {:>22.2f} {:>22.2f}\n", threads, 100 - writePercent, writePercent,
+                 lockedOps / 1e6, shardedOps / 1e6);
+    }
+  }
+}
+
 int main()
 {
+  testConcurrentHashMap();
+  benchConcurrentHashMap();
+
   fmt::print("Hello ReadWriteLock\n");
   // 写线程
   std::vector<std::thread> writers;
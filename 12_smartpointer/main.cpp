@@ -3,9 +3,17 @@
 #include <chrono>
 #include <memory>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <fstream>
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include "file_sink.hpp"
+#include "mapped_file.hpp"
+
 /**
  * std::unique_ptr 是 C++11 引入的一种智能指针，用于管理动态分配的对象，保证在指针生命周期结束时自动释放内存。
  * 它具有独占所有权的特点，即同一时间内只能有一个 unique_ptr 指向某个对象，因此不允许拷贝，但可以通过移动语义转移所有权。
@@ -100,6 +108,200 @@ void test05()
   std::unique_ptr<Object[]> objArr = std::make_unique<Object[]>(3);
 }
 
+/// @brief file_sink: RAII 的缓冲文件写入器, 析构时自动刷新并关闭文件
+void test06()
+{
+  {
+    file_sink sink("example_sink.txt");
+    for(int i = 0; i < 3; ++i)
+    {
+      sink.write(fmt::format("record {}\n", i));
+    }
+    sink.flush();
+    fmt::print("file_sink wrote {} bytes\n", sink.bytesWritten());
+  }
+  std::remove("example_sink.txt");
+}
+
+/// @brief 小记录日志写入吞吐量: fwrite vs ofstream vs file_sink
+void benchFileSink()
+{
+  constexpr std::size_t kTotalBytes = 256ull << 20; // 写入总量
+  const char *path = "file_sink_bench.log";
+
+  // 预先生成一批日志记录, 测试只衡量写入开销
+  std::vector<std::string> records;
+  for(int i = 0; i < 1024; ++i)
+  {
+    records.push_back(fmt::format("2025-01-01 12:00:{:02d}.{:06d} [INFO] request id={} latency={}us status=200\n", i % 60,
+                                  i * 977 % 1000000, i * 7919, i % 500));
+  }
+
+  auto run = [&](const char *name, auto &&write)
+  {
+    std::size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    write(bytes);
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    fmt::println("  {:<40} {:>8.1f} MB/s", name, static_cast<double>(bytes) / seconds / 1e6);
+    std::remove(path);
+  };
+  auto records_loop = [&](std::size_t &bytes, auto &&write_one)
+  {
+    for(std::size_t i = 0; bytes < kTotalBytes; ++i)
+    {
+      const std::string &r = records[i % records.size()];
+      write_one(r);
+      bytes += r.size();
+    }
+  };
+
+  fmt::println("========== benchmark: small-record logging, {} MB (write + close, no fsync) ==========",
+               kTotalBytes >> 20);
+  run("fwrite", [&](std::size_t &bytes)
+      {
+        std::unique_ptr<FILE, int (*)(FILE *)> file(fopen(path, "wb"), &fclose); // FileCloser 会打印, 这里直接 fclose
+        records_loop(bytes, [&](const std::string &r) { fwrite(r.data(), 1, r.size(), file.get()); });
+      });
+  run("std::ofstream", [&](std::size_t &bytes)
+      {
+        std::ofstream out(path, std::ios::binary);
+        records_loop(bytes, [&](const std::string &r) { out.write(r.data(), static_cast<std::streamsize>(r.size())); });
+      });
+  run("file_sink (sync)", [&](std::size_t &bytes)
+      {
+        file_sink::Options options;
+        options.async = false;
+        file_sink sink(path, options);
+        records_loop(bytes, [&](const std::string &r) { sink.write(r); });
+      });
+  run("file_sink (async writev)", [&](std::size_t &bytes)
+      {
+        file_sink sink(path);
+        records_loop(bytes, [&](const std::string &r) { sink.write(r); });
+      });
+  bool direct = false;
+  run("file_sink (async writev, direct io)", [&](std::size_t &bytes)
+      {
+        file_sink::Options options;
+        options.direct_io = true;
+        file_sink sink(path, options);
+        direct = sink.directIo();
+        records_loop(bytes, [&](const std::string &r) { sink.write(r); });
+      });
+  if(!direct)
+  {
+    fmt::println("  (当前文件系统不支持 direct io, 最后一行退回了普通写)");
+  }
+}
+
+/// @brief 统计换行符数量
+std::size_t countLines(std::string_view text)
+{
+  std::size_t lines = 0;
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while((p = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)))) != nullptr)
+  {
+    ++lines;
+    ++p;
+  }
+  return lines;
+}
+
+#if MAPPED_FILE_SUPPORTED
+/// @brief mapped_file: 像访问字符串一样访问整个文件
+void test07()
+{
+  {
+    file_sink sink("example_mmap.txt");
+    sink.write("line 1\nline 2\nline 3\n");
+  }
+  mapped_file file("example_mmap.txt");
+  file.advise(access_hint::sequential);
+  fmt::print("mapped {} bytes, {} lines, first line = {}\n", file.size(), countLines(file.view()),
+             file.view().substr(0, file.view().find('\n')));
+  std::remove("example_mmap.txt");
+}
+
+/// @brief 按行扫描大文件: fread vs mmap vs 滑动窗口 mmap
+/// 文件大小默认 512MB, 可以通过环境变量 MMAP_BENCH_MB 修改(例如 4096 测试多 GB 文件)
+void benchMappedFile()
+{
+  std::size_t megabytes = 512;
+  if(const char *env = std::getenv("MMAP_BENCH_MB"))
+  {
+    megabytes = std::strtoull(env, nullptr, 10);
+  }
+  const char *path = "mapped_file_bench.log";
+  {
+    file_sink sink(path);
+    std::size_t bytes = 0;
+    for(int i = 0; bytes < (megabytes << 20); ++i)
+    {
+      std::string line = fmt::format("{:08d} [INFO] request id={} latency={}us\n", i, i * 7919, i % 500);
+      sink.write(line);
+      bytes += line.size();
+    }
+  }
+
+  auto run = [&](const char *name, auto &&count)
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t lines = count();
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    fmt::println("  {:<40} {:>8.1f} MB/s  ({} lines)", name, static_cast<double>(megabytes << 20) / seconds / 1e6,
+                 lines);
+  };
+
+  fmt::println("========== benchmark: line scanning, {} MB file (page cache warm) ==========", megabytes);
+  run("fread (1MB buffer)", [&]
+      {
+        std::unique_ptr<FILE, int (*)(FILE *)> file(fopen(path, "rb"), &fclose);
+        std::vector<char> buffer(1 << 20);
+        std::size_t lines = 0;
+        std::size_t n = 0;
+        while((n = fread(buffer.data(), 1, buffer.size(), file.get())) > 0)
+        {
+          lines += countLines(std::string_view(buffer.data(), n));
+        }
+        return lines;
+      });
+  run("mapped_file (sequential)", [&]
+      {
+        mapped_file file(path);
+        file.advise(access_hint::sequential);
+        return countLines(file.view());
+      });
+  bool huge = false;
+  run("mapped_file (sequential, huge pages)", [&]
+      {
+        mapped_file file(path);
+        file.advise(access_hint::sequential);
+        huge = file.adviseHugePages();
+        return countLines(file.view());
+      });
+  run("mapped_window (64MB windows)", [&]
+      {
+        mapped_window window(path, 64 << 20);
+        std::size_t lines = 0;
+        std::string_view chunk;
+        while(window.next(chunk))
+        {
+          lines += countLines(chunk);
+        }
+        return lines;
+      });
+  if(!huge)
+  {
+    fmt::println("  (内核不支持文件映射的透明大页, MADV_HUGEPAGE 被忽略)");
+  }
+  std::remove(path);
+}
+#endif
+
 int main()
 {
   test01();
@@ -112,4 +314,13 @@ int main()
   fmt::println("---------------------------------------------------");
   test05();
   fmt::println("---------------------------------------------------");
+  test06();
+  fmt::println("---------------------------------------------------");
+  benchFileSink();
+#if MAPPED_FILE_SUPPORTED
+  fmt::println("---------------------------------------------------");
+  test07();
+  fmt::println("---------------------------------------------------");
+  benchMappedFile();
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,237 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+/**
+ * mapped_file: mmap 的 RAII 封装, 只读地把整个文件映射到内存, 以 std::string_view 的形式访问.
+ * mapped_window: 滑动窗口模式, 每次只映射文件的一段(例如 64MB), 用于超过地址空间预算的大文件.
+ *
+ * 与 fread 相比, mmap 省去了 "内核页缓存 -> 用户缓冲区" 的拷贝, 页缓存本身就是被访问的内存.
+ * 访问模式提示(madvise):
+ *   sequential : 内核加大预读, 已经读过的页可以尽早回收.
+ *   random     : 关闭预读, 适合随机查找.
+ *   willneed   : 立即开始异步预读.
+ *   huge pages : MADV_HUGEPAGE, 减少 TLB 缺失(文件映射需要内核支持 CONFIG_READ_ONLY_THP_FOR_FS, 不支持时返回 false).
+ *
+ * 仅支持 POSIX 平台(Linux / macOS), 其他平台 MAPPED_FILE_SUPPORTED 为 0.
+ * C++17 没有 std::span, 需要字节视图时使用 data() / size().
+ */
+
+#if defined(_WIN32)
+#define MAPPED_FILE_SUPPORTED 0
+#else
+#define MAPPED_FILE_SUPPORTED 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+enum class access_hint
+{
+  normal,
+  sequential,
+  random,
+  willneed,
+};
+
+namespace detail
+{
+/// @brief 文件描述符的 RAII 封装
+class unique_fd
+{
+ public:
+  unique_fd() noexcept = default;
+  explicit unique_fd(int fd) noexcept : fd_(fd) {}
+  unique_fd(unique_fd &&other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+  unique_fd &operator=(unique_fd &&other) noexcept
+  {
+    std::swap(fd_, other.fd_);
+    return *this;
+  }
+  unique_fd(const unique_fd &) = delete;
+  unique_fd &operator=(const unique_fd &) = delete;
+  ~unique_fd()
+  {
+    if (fd_ >= 0) ::close(fd_);
+  }
+
+  [[nodiscard]] int get() const noexcept
+  {
+    return fd_;
+  }
+
+ private:
+  int fd_ = -1;
+};
+
+inline unique_fd openReadOnly(const char *path, std::size_t &size)
+{
+  unique_fd fd(::open(path, O_RDONLY));
+  if (fd.get() < 0) throw std::system_error(errno, std::generic_category(), path);
+  struct stat st = {};
+  if (::fstat(fd.get(), &st) != 0) throw std::system_error(errno, std::generic_category(), path);
+  size = static_cast<std::size_t>(st.st_size);
+  return fd;
+}
+
+inline void *mapReadOnly(int fd, std::size_t length, std::size_t offset)
+{
+  void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(offset));
+  if (addr == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+  return addr;
+}
+
+inline bool advise(void *addr, std::size_t length, access_hint hint) noexcept
+{
+  int advice = MADV_NORMAL;
+  switch (hint)
+  {
+  case access_hint::normal: advice = MADV_NORMAL; break;
+  case access_hint::sequential: advice = MADV_SEQUENTIAL; break;
+  case access_hint::random: advice = MADV_RANDOM; break;
+  case access_hint::willneed: advice = MADV_WILLNEED; break;
+  }
+  return length == 0 || ::madvise(addr, length, advice) == 0;
+}
+
+inline std::size_t pageSize() noexcept
+{
+  static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+}  // namespace detail
+
+class mapped_file
+{
+ public:
+  mapped_file() noexcept = default;
+
+  /// @brief 映射整个文件, 失败时抛出 std::system_error; 映射完成后文件描述符即可关闭
+  explicit mapped_file(const char *path)
+  {
+    detail::unique_fd fd = detail::openReadOnly(path, size_);
+    if (size_ > 0) data_ = detail::mapReadOnly(fd.get(), size_, 0);  // 长度为 0 的 mmap 会失败
+  }
+
+  mapped_file(mapped_file &&other) noexcept :
+    data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+  {
+  }
+
+  mapped_file &operator=(mapped_file &&other) noexcept
+  {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  ~mapped_file()
+  {
+    if (data_ != nullptr) ::munmap(data_, size_);
+  }
+
+  [[nodiscard]] std::string_view view() const noexcept
+  {
+    return {static_cast<const char *>(data_), size_};
+  }
+
+  [[nodiscard]] const std::byte *data() const noexcept
+  {
+    return static_cast<const std::byte *>(data_);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @brief 对整个映射区域给出访问模式提示
+  bool advise(access_hint hint) const noexcept
+  {
+    return detail::advise(data_, size_, hint);
+  }
+
+  /// @brief 请求使用透明大页, 内核或文件系统不支持时返回 false
+  bool adviseHugePages() const noexcept
+  {
+#if defined(MADV_HUGEPAGE)
+    return size_ > 0 && ::madvise(data_, size_, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+  }
+
+ private:
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/// @brief 滑动窗口映射: 按顺序逐段映射文件, 每段在最后一个换行符处结束, 保证一行不会被拆到两段中
+/// (单行长度超过窗口时按窗口大小截断)
+class mapped_window
+{
+ public:
+  /// @param window_size 每次映射的字节数, 向上取整到页大小的倍数
+  mapped_window(const char *path, std::size_t window_size)
+  {
+    fd_ = detail::openReadOnly(path, file_size_);
+    const std::size_t page = detail::pageSize();
+    window_size_ = (std::max(window_size, page) + page - 1) / page * page;
+  }
+
+  mapped_window(const mapped_window &) = delete;
+  mapped_window &operator=(const mapped_window &) = delete;
+  ~mapped_window()
+  {
+    unmap();
+  }
+
+  /// @brief 映射下一段并返回其内容, 文件结束时返回 false; 上一段返回的 string_view 随之失效
+  bool next(std::string_view &chunk)
+  {
+    unmap();
+    if (position_ >= file_size_) return false;
+    // mmap 的偏移必须按页对齐, 窗口从 position_ 所在的页开始
+    const std::size_t page = detail::pageSize();
+    const std::size_t map_offset = position_ / page * page;
+    map_size_ = std::min(window_size_, file_size_ - map_offset);
+    map_ = detail::mapReadOnly(fd_.get(), map_size_, map_offset);
+    detail::advise(map_, map_size_, access_hint::sequential);
+
+    const char *begin = static_cast<const char *>(map_) + (position_ - map_offset);
+    const char *end = static_cast<const char *>(map_) + map_size_;
+    if (map_offset + map_size_ < file_size_)
+    {
+      // 不是最后一段: 在最后一个换行符之后截断, 剩下的半行留给下一段
+      const char *cut = end;
+      while (cut > begin && cut[-1] != '\n') --cut;
+      if (cut > begin) end = cut;
+    }
+    chunk = std::string_view(begin, static_cast<std::size_t>(end - begin));
+    position_ += chunk.size();
+    return true;
+  }
+
+ private:
+  void unmap() noexcept
+  {
+    if (map_ != nullptr) ::munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+
+  detail::unique_fd fd_;
+  std::size_t file_size_ = 0;
+  std::size_t window_size_ = 0;
+  std::size_t position_ = 0;
+  void *map_ = nullptr;
+  std::size_t map_size_ = 0;
+};
+#endif
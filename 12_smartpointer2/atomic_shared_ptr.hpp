@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "intrusive_ptr.hpp"
+
+/**
+ * atomic_shared_ptr: 无锁的原子共享指针(分离引用计数 / split reference counting).
+ *
+ * 多个线程同时读写同一个 shared_ptr 变量需要加锁(例如 shared_mutex), std::atomic_load(&sp) 在 libstdc++ 中
+ * 也是用全局的互斥锁池实现的. 难点在于: 读线程 "读取指针" 和 "增加引用计数" 是两步操作, 中间指针可能被替换并释放.
+ *
+ * 分离引用计数把这两步合并成一次原子操作:
+ *   - 一个 64 位字同时保存指针(高 48 位)和本地计数(低 16 位).
+ *   - store 时先替对象预付 kBatch 个引用(全局计数 += kBatch), 这些引用归这个 64 位字所有.
+ *   - load 只做一次 fetch_add(1): 本地计数 +1, 相当于从预付的引用中领走一个, 直接 adopt 成 intrusive_ptr.
+ *   - 替换指针(store/exchange/CAS)时, 旧字中还没被领走的 kBatch - 本地计数 个引用一次性归还.
+ *   - 读线程看到本地计数不小于 kBatch / 2 时补充预付引用并把本地计数清零(多个读线程同时补充时只有一个 CAS 成功,
+ *     某个读线程在补充前被挂起, 后面的读线程仍然会补充).
+ *   - 本地计数达到 kBatch 说明预付的引用已经全部领走, 再替换指针时没有引用可以归还, 继续运行可能提前删除对象,
+ *     直接 std::terminate().
+ *
+ * 对象通过 intrusive_ptr 管理, 类型需要继承 intrusive_ref_counter<T>(必须是默认的 thread_safe_counter).
+ * 限制: 只支持 64 位平台, 且指针必须能用 48 位表示(x86-64 / AArch64 用户态地址满足这个条件).
+ */
+template <typename T>
+class atomic_shared_ptr
+{
+  static_assert(sizeof(void *) == 8, "atomic_shared_ptr 需要 64 位平台");
+
+ public:
+  using value_type = intrusive_ptr<T>;
+
+  static constexpr unsigned int kLocalBits = 16;
+  static constexpr unsigned int kBatch = 1U << 15;  // 每次预付的引用数, 本地计数不能超过它
+
+  atomic_shared_ptr() noexcept = default;
+  explicit atomic_shared_ptr(intrusive_ptr<T> desired) noexcept : word_(prepay(desired.get())) {}
+  atomic_shared_ptr(const atomic_shared_ptr &) = delete;
+  atomic_shared_ptr &operator=(const atomic_shared_ptr &) = delete;
+  ~atomic_shared_ptr()
+  {
+    refund(word_.load(std::memory_order_relaxed));
+  }
+
+  static constexpr bool is_always_lock_free = std::atomic<std::uint64_t>::is_always_lock_free;
+
+  /// @brief 读取: 一次 fetch_add, 必要时补充预付引用
+  intrusive_ptr<T> load() const noexcept
+  {
+    std::uint64_t word = word_.fetch_add(1, std::memory_order_acquire) + 1;
+    T *ptr = pointerOf(word);
+    if (ptr == nullptr)
+    {
+      undoNullLoad(word);
+      return {};
+    }
+    // 需要 kBatch / 2 个以上的读线程同时停在 fetch_add 和 replenish 之间才会达到; 不能只用 assert, Release 构建中同样检查
+    if (localOf(word) >= kBatch) std::terminate();
+    if (localOf(word) >= kBatch / 2) replenish(word);
+    return intrusive_ptr<T>(ptr, false);  // adopt 领走的那个引用
+  }
+
+  void store(intrusive_ptr<T> desired) noexcept
+  {
+    exchange(std::move(desired));
+  }
+
+  intrusive_ptr<T> exchange(intrusive_ptr<T> desired) noexcept
+  {
+    std::uint64_t old = word_.exchange(prepay(desired.get()), std::memory_order_acq_rel);
+    T *ptr = pointerOf(old);
+    if (ptr == nullptr) return {};
+    // 旧字拥有的 kBatch 个引用中, 本地计数个已经被读线程领走; 剩下的留一个给返回值, 其余归还.
+    // 全部被领走时(load 会终止程序, 这里只是防止无符号减法回绕)返回值自己增加一个引用
+    const unsigned int local = localOf(old);
+    if (local >= kBatch) return intrusive_ptr<T>(ptr, true);
+    intrusive_ptr_release(ptr, kBatch - local - 1);
+    return intrusive_ptr<T>(ptr, false);
+  }
+
+  /// @brief 当前指针等于 expected 时替换为 desired 并返回 true; 否则把当前值写入 expected 并返回 false
+  bool compare_exchange_strong(intrusive_ptr<T> &expected, intrusive_ptr<T> desired) noexcept
+  {
+    const std::uint64_t fresh = prepay(desired.get());
+    std::uint64_t current = word_.load(std::memory_order_relaxed);
+    while (pointerOf(current) == expected.get())
+    {
+      // 本地计数被读线程修改会导致 CAS 失败, 此时指针没变, 重试即可
+      if (word_.compare_exchange_weak(current, fresh, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        refund(current);
+        return true;
+      }
+    }
+    refund(fresh);
+    expected = load();
+    return false;
+  }
+
+  operator intrusive_ptr<T>() const noexcept  // NOLINT(google-explicit-constructor)
+  {
+    return load();
+  }
+
+  atomic_shared_ptr &operator=(intrusive_ptr<T> desired) noexcept
+  {
+    store(std::move(desired));
+    return *this;
+  }
+
+ private:
+  static constexpr std::uint64_t kLocalMask = (std::uint64_t{1} << kLocalBits) - 1;
+
+  static T *pointerOf(std::uint64_t word) noexcept
+  {
+    return reinterpret_cast<T *>(word >> kLocalBits);  // NOLINT(performance-no-int-to-ptr)
+  }
+
+  static unsigned int localOf(std::uint64_t word) noexcept
+  {
+    return static_cast<unsigned int>(word & kLocalMask);
+  }
+
+  /// @brief 为即将放入的指针预付 kBatch 个引用, 返回本地计数为 0 的字
+  static std::uint64_t prepay(T *ptr) noexcept
+  {
+    if (ptr == nullptr) return 0;
+    const auto bits = reinterpret_cast<std::uint64_t>(ptr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    assert((bits >> (64 - kLocalBits)) == 0 && "指针超过 48 位");
+    intrusive_ptr_add_ref(ptr, kBatch);
+    return bits << kLocalBits;
+  }
+
+  /// @brief 归还一个已经被替换下来的字中未被领走的引用
+  static void refund(std::uint64_t word) noexcept
+  {
+    if (T *ptr = pointerOf(word)) intrusive_ptr_release(ptr, kBatch - localOf(word));
+  }
+
+  /// @brief 把已经领走的本地计数转成全局计数: 先补充引用, 再把本地计数清零; 指针被替换时撤销
+  void replenish(std::uint64_t word) const noexcept
+  {
+    T *ptr = pointerOf(word);
+    while (pointerOf(word) == ptr && localOf(word) >= kBatch / 2)
+    {
+      const unsigned int local = localOf(word);
+      intrusive_ptr_add_ref(ptr, local);
+      if (word_.compare_exchange_weak(word, word - local, std::memory_order_acq_rel, std::memory_order_relaxed))
+        return;
+      intrusive_ptr_release(ptr, local);  // 当前线程还持有一个引用, 这里不会减到 0
+    }
+  }
+
+  /// @brief 空指针不需要引用, 撤销 load 对本地计数的修改, 防止频繁读取空指针时本地计数溢出
+  void undoNullLoad(std::uint64_t word) const noexcept
+  {
+    while (pointerOf(word) == nullptr && localOf(word) > 0)
+    {
+      if (word_.compare_exchange_weak(word, word - 1, std::memory_order_relaxed)) return;
+    }
+  }
+
+  mutable std::atomic<std::uint64_t> word_{0};
+};
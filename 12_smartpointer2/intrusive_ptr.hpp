@@ -0,0 +1,224 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * intrusive_ptr: 侵入式引用计数智能指针.
+ *
+ * shared_ptr 的引用计数放在单独的控制块里(make_shared 时与对象相邻), 控制块中还有弱引用计数, 删除器, 虚函数表等;
+ * shared_ptr 本身也是两个指针大小.
+ * intrusive_ptr 把引用计数直接嵌入对象内部:
+ *   - 指针本身只有一个指针大小, 创建对象只有一次分配, 没有控制块.
+ *   - 可以随时从裸指针重新构造 intrusive_ptr(计数就在对象里), 不会出现两个控制块导致重复释放的问题.
+ *   - 可以选择非原子计数(thread_unsafe_counter), 单线程场景下拷贝/销毁只是普通的加减法.
+ *   - 代价: 类型需要继承 intrusive_ref_counter(或自己提供 intrusive_ptr_add_ref / intrusive_ptr_release), 不支持弱引用.
+ *
+ * 所有权语义(与 boost::intrusive_ptr 相同):
+ *   intrusive_ptr<T> p(raw);         // attach: 引用计数 +1, 与已有的持有者共享对象
+ *   intrusive_ptr<T> p(raw, false);  // adopt : 接管一个已经计过数的引用, 计数不变
+ *   T *raw = p.detach();             // 放弃持有但不减计数, 之后需要由别人 adopt 或手动 release
+ */
+
+/// @brief 原子计数策略(默认), 可以跨线程共享对象
+struct thread_safe_counter
+{
+  using type = std::atomic<unsigned int>;
+  static unsigned int load(const type &c) noexcept
+  {
+    return c.load(std::memory_order_relaxed);
+  }
+  static void increment(type &c) noexcept
+  {
+    c.fetch_add(1, std::memory_order_relaxed);  // 已经持有引用才能增加引用, 不需要同步
+  }
+  static bool decrement(type &c) noexcept  // 返回 true 表示计数归零
+  {
+    return c.fetch_sub(1, std::memory_order_acq_rel) == 1;  // 保证其他线程对对象的写入在析构前可见
+  }
+  static void add(type &c, unsigned int n) noexcept
+  {
+    c.fetch_add(n, std::memory_order_relaxed);
+  }
+  static bool subtract(type &c, unsigned int n) noexcept
+  {
+    return c.fetch_sub(n, std::memory_order_acq_rel) == n;
+  }
+};
+
+/// @brief 非原子计数策略, 对象只在一个线程内使用时更快
+struct thread_unsafe_counter
+{
+  using type = unsigned int;
+  static unsigned int load(const type &c) noexcept
+  {
+    return c;
+  }
+  static void increment(type &c) noexcept
+  {
+    ++c;
+  }
+  static bool decrement(type &c) noexcept
+  {
+    return --c == 0;
+  }
+  static void add(type &c, unsigned int n) noexcept
+  {
+    c += n;
+  }
+  static bool subtract(type &c, unsigned int n) noexcept
+  {
+    return (c -= n) == 0;
+  }
+};
+
+/// @brief 嵌入式引用计数基类, 计数归零时 delete 派生类对象(不需要虚析构函数)
+/// @tparam Derived 派生类类型(CRTP)
+/// @tparam CounterPolicy thread_safe_counter 或 thread_unsafe_counter
+template <typename Derived, typename CounterPolicy = thread_safe_counter>
+class intrusive_ref_counter
+{
+ public:
+  [[nodiscard]] unsigned int use_count() const noexcept
+  {
+    return CounterPolicy::load(count_);
+  }
+
+  friend void intrusive_ptr_add_ref(const intrusive_ref_counter *p) noexcept
+  {
+    CounterPolicy::increment(p->count_);
+  }
+
+  friend void intrusive_ptr_release(const intrusive_ref_counter *p) noexcept
+  {
+    if (CounterPolicy::decrement(p->count_)) delete static_cast<const Derived *>(p);
+  }
+
+  /// @brief 一次增加/减少 n 个引用, 供 atomic_shared_ptr 批量预付引用计数
+  friend void intrusive_ptr_add_ref(const intrusive_ref_counter *p, unsigned int n) noexcept
+  {
+    CounterPolicy::add(p->count_, n);
+  }
+
+  friend void intrusive_ptr_release(const intrusive_ref_counter *p, unsigned int n) noexcept
+  {
+    if (CounterPolicy::subtract(p->count_, n)) delete static_cast<const Derived *>(p);
+  }
+
+ protected:
+  intrusive_ref_counter() noexcept = default;
+  // 拷贝对象时不拷贝引用计数: 新对象还没有任何持有者
+  intrusive_ref_counter(const intrusive_ref_counter &) noexcept {}
+  intrusive_ref_counter &operator=(const intrusive_ref_counter &) noexcept
+  {
+    return *this;
+  }
+  ~intrusive_ref_counter() = default;
+
+ private:
+  mutable typename CounterPolicy::type count_{0};
+};
+
+template <typename T>
+class intrusive_ptr
+{
+ public:
+  using element_type = T;
+
+  constexpr intrusive_ptr() noexcept = default;
+
+  /// @brief add_ref 为 true 时 attach(计数 +1), 为 false 时 adopt(接管已有的一个引用)
+  intrusive_ptr(T *p, bool add_ref = true) noexcept : ptr_(p)  // NOLINT(google-explicit-constructor)
+  {
+    if (ptr_ != nullptr && add_ref) intrusive_ptr_add_ref(ptr_);
+  }
+
+  intrusive_ptr(const intrusive_ptr &other) noexcept : intrusive_ptr(other.ptr_) {}
+  intrusive_ptr(intrusive_ptr &&other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+  /// @brief 派生类指针到基类指针的转换
+  template <typename U>
+  intrusive_ptr(const intrusive_ptr<U> &other) noexcept : intrusive_ptr(other.get())  // NOLINT
+  {
+  }
+
+  ~intrusive_ptr()
+  {
+    if (ptr_ != nullptr) intrusive_ptr_release(ptr_);
+  }
+
+  intrusive_ptr &operator=(const intrusive_ptr &other) noexcept
+  {
+    intrusive_ptr(other).swap(*this);
+    return *this;
+  }
+
+  intrusive_ptr &operator=(intrusive_ptr &&other) noexcept
+  {
+    intrusive_ptr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept
+  {
+    intrusive_ptr().swap(*this);
+  }
+
+  void reset(T *p, bool add_ref = true) noexcept
+  {
+    intrusive_ptr(p, add_ref).swap(*this);
+  }
+
+  /// @brief 放弃持有但不减少引用计数, 返回裸指针
+  [[nodiscard]] T *detach() noexcept
+  {
+    return std::exchange(ptr_, nullptr);
+  }
+
+  [[nodiscard]] T *get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T &operator*() const noexcept
+  {
+    return *ptr_;
+  }
+
+  T *operator->() const noexcept
+  {
+    return ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+  void swap(intrusive_ptr &other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+  }
+
+ private:
+  T *ptr_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const intrusive_ptr<T> &a, const intrusive_ptr<U> &b) noexcept
+{
+  return a.get() == b.get();
+}
+
+template <typename T, typename U>
+bool operator!=(const intrusive_ptr<T> &a, const intrusive_ptr<U> &b) noexcept
+{
+  return a.get() != b.get();
+}
+
+/// @brief 与 make_shared 对应: 一次分配, 返回 attach 后的指针
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args &&...args)
+{
+  return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
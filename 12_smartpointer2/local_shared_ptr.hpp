@@ -0,0 +1,204 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * local_shared_ptr: 只能在一个线程内使用的 shared_ptr.
+ *
+ * std::shared_ptr 的引用计数是原子操作, 即使对象从来不离开创建它的线程, 每次拷贝/销毁也要付出原子操作的代价.
+ * local_shared_ptr 的控制块使用普通整数计数, 拷贝/销毁只是一次普通的加减法.
+ *
+ * 限制:
+ *   - 对象及其所有 local_shared_ptr 必须始终只在创建它的线程中使用.
+ *   - 不支持 weak_ptr, 不支持自定义删除器和分配器.
+ *
+ * Debug 构建(未定义 NDEBUG)时, 控制块会记录创建线程的 id, 每次拷贝/销毁都会检查当前线程, 跨线程使用会触发断言.
+ * 也可以手动定义 LOCAL_SHARED_PTR_CHECK_THREAD 为 0 或 1 来关闭或开启检查.
+ */
+
+#ifndef LOCAL_SHARED_PTR_CHECK_THREAD
+#ifdef NDEBUG
+#define LOCAL_SHARED_PTR_CHECK_THREAD 0
+#else
+#define LOCAL_SHARED_PTR_CHECK_THREAD 1
+#endif
+#endif
+
+namespace detail
+{
+/// @brief 非原子引用计数的控制块
+struct local_control_block
+{
+  std::size_t use_count = 1;
+  void (*destroy)(local_control_block *) = nullptr;  // 销毁对象并释放控制块, 用函数指针代替虚函数
+#if LOCAL_SHARED_PTR_CHECK_THREAD
+  std::thread::id owner = std::this_thread::get_id();
+#endif
+
+  void checkThread() const
+  {
+#if LOCAL_SHARED_PTR_CHECK_THREAD
+    assert(owner == std::this_thread::get_id() && "local_shared_ptr 被跨线程使用");
+#endif
+  }
+};
+
+/// @brief make_local_shared 使用: 控制块和对象在同一次分配中
+template <typename T>
+struct local_inplace_block : local_control_block
+{
+  alignas(T) unsigned char storage[sizeof(T)];
+
+  T *object() noexcept
+  {
+    return std::launder(reinterpret_cast<T *>(storage));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  static void destroyImpl(local_control_block *block)
+  {
+    auto *self = static_cast<local_inplace_block *>(block);
+    self->object()->~T();
+    delete self;
+  }
+};
+
+/// @brief 从裸指针构造时使用: 对象和控制块分开分配
+template <typename T>
+struct local_pointer_block : local_control_block
+{
+  T *ptr = nullptr;
+
+  static void destroyImpl(local_control_block *block)
+  {
+    auto *self = static_cast<local_pointer_block *>(block);
+    delete self->ptr;
+    delete self;
+  }
+};
+}  // namespace detail
+
+template <typename T>
+class local_shared_ptr
+{
+ public:
+  using element_type = T;
+
+  constexpr local_shared_ptr() noexcept = default;
+
+  /// @brief 接管 new 出来的对象(两次分配), 推荐使用 make_local_shared
+  explicit local_shared_ptr(T *p) : ptr_(p)
+  {
+    if (p == nullptr) return;
+    auto *block = new (std::nothrow) detail::local_pointer_block<T>;
+    if (block == nullptr)
+    {
+      delete p;
+      throw std::bad_alloc{};
+    }
+    block->ptr = p;
+    block->destroy = &detail::local_pointer_block<T>::destroyImpl;
+    block_ = block;
+  }
+
+  local_shared_ptr(const local_shared_ptr &other) noexcept : ptr_(other.ptr_), block_(other.block_)
+  {
+    if (block_ != nullptr)
+    {
+      block_->checkThread();
+      ++block_->use_count;
+    }
+  }
+
+  local_shared_ptr(local_shared_ptr &&other) noexcept :
+    ptr_(std::exchange(other.ptr_, nullptr)), block_(std::exchange(other.block_, nullptr))
+  {
+  }
+
+  ~local_shared_ptr()
+  {
+    if (block_ != nullptr)
+    {
+      block_->checkThread();
+      if (--block_->use_count == 0) block_->destroy(block_);
+    }
+  }
+
+  local_shared_ptr &operator=(const local_shared_ptr &other) noexcept
+  {
+    local_shared_ptr(other).swap(*this);
+    return *this;
+  }
+
+  local_shared_ptr &operator=(local_shared_ptr &&other) noexcept
+  {
+    local_shared_ptr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept
+  {
+    local_shared_ptr().swap(*this);
+  }
+
+  void swap(local_shared_ptr &other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+    std::swap(block_, other.block_);
+  }
+
+  [[nodiscard]] T *get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T &operator*() const noexcept
+  {
+    return *ptr_;
+  }
+
+  T *operator->() const noexcept
+  {
+    return ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+  [[nodiscard]] std::size_t use_count() const noexcept
+  {
+    return block_ != nullptr ? block_->use_count : 0;
+  }
+
+ private:
+  template <typename U, typename... Args>
+  friend local_shared_ptr<U> make_local_shared(Args &&...args);
+
+  local_shared_ptr(T *p, detail::local_control_block *block) noexcept : ptr_(p), block_(block) {}
+
+  T *ptr_ = nullptr;
+  detail::local_control_block *block_ = nullptr;
+};
+
+/// @brief 与 make_shared 对应: 控制块和对象一次分配
+template <typename T, typename... Args>
+local_shared_ptr<T> make_local_shared(Args &&...args)
+{
+  auto *block = new detail::local_inplace_block<T>;
+  try
+  {
+    ::new (static_cast<void *>(block->storage)) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    delete block;
+    throw;
+  }
+  block->destroy = &detail::local_inplace_block<T>::destroyImpl;
+  return local_shared_ptr<T>(block->object(), block);
+}
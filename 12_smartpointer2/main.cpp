@@ -1,8 +1,27 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "atomic_shared_ptr.hpp"
+#include "bench.hpp"
+#include "intrusive_ptr.hpp"
+#include "local_shared_ptr.hpp"
+#include "pool_allocator.hpp"
 
 /**
  * std::shared_ptr 是 C++ 标准库提供的智能指针，用于多个对象共享同一资源的所有权，当最后一个 shared_ptr
@@ -28,15 +47,16 @@
 
 struct Object
 {
+  static inline bool verbose = true;  // 性能测试时关闭构造/析构的打印
   int id_ = 0;
   explicit Object(int id = 0) : id_(id)
   {
-    fmt::print("Object constructor\n");
+    if (verbose) fmt::print("Object constructor\n");
   }
 
   ~Object()
   {
-    fmt::print("~Object destructor\n");
+    if (verbose) fmt::print("~Object destructor\n");
   }
   Object(const Object &) = default;
   Object &operator=(const Object &) = default;
@@ -94,6 +114,342 @@ void test03()
   }
 }
 
+/// @brief 嵌入了引用计数的 Object, 原子计数
+struct RcObject : Object, intrusive_ref_counter<RcObject>
+{
+  using Object::Object;
+};
+
+/// @brief 嵌入了引用计数的 Object, 非原子计数, 只能在一个线程内使用
+struct LocalRcObject : Object, intrusive_ref_counter<LocalRcObject, thread_unsafe_counter>
+{
+  using Object::Object;
+};
+
+void test04()
+{
+  intrusive_ptr<RcObject> ip = make_intrusive<RcObject>(300);  // 只有一次分配, 计数就在对象里
+  fmt::print("ip id = {}, use_count = {}\n", ip->id(), ip->use_count());
+  auto ip2 = ip;  // 拷贝: 计数 +1
+  fmt::print("use_count = {}\n", ip->use_count());
+
+  RcObject *raw = ip2.detach();  // 放弃持有但不减计数
+  fmt::print("after detach use_count = {}\n", ip->use_count());
+  intrusive_ptr<RcObject> ip3(raw, false);  // adopt: 接管 detach 出来的引用, 计数不变
+  fmt::print("after adopt use_count = {}\n", ip->use_count());
+  intrusive_ptr<RcObject> ip4(ip.get());  // attach: 从裸指针再构造一个持有者也是安全的, 计数 +1
+  fmt::print("after attach use_count = {}\n", ip->use_count());
+  fmt::print("sizeof(shared_ptr<Object>) = {}, sizeof(intrusive_ptr<RcObject>) = {}\n", sizeof(std::shared_ptr<Object>),
+             sizeof(intrusive_ptr<RcObject>));
+}
+
+/// @brief 与 test02 相同的操作, 对象只在当前线程使用时可以换成非原子计数的 local_shared_ptr
+void test05()
+{
+  local_shared_ptr<Object> osp = make_local_shared<Object>(200);  // 控制块和对象一次分配
+  fmt::print("osp id = {}\n", osp->id());
+  auto sp2 = osp;  // 计数只是普通的 ++, 不是原子操作
+  auto sp3 = sp2;
+  fmt::print("use_count = {}\n", osp.use_count());
+  sp2.reset();
+  fmt::print("use_count = {}\n", osp.use_count());
+  sp3.reset();
+  fmt::print("use_count = {}\n", osp.use_count());
+  // 跨线程使用会在 Debug 构建下触发断言:
+  // std::thread([osp] { auto copy = osp; }).join();
+}
+
+/// @brief 对比 shared_ptr 与 intrusive_ptr 的创建/销毁, 拷贝开销
+void benchIntrusive()
+{
+  constexpr int kObjects = 1'000'000;
+  constexpr int kCopies = 10'000'000;
+  fmt::println("========== benchmark: shared_ptr vs intrusive_ptr ==========");
+  Object::verbose = false;
+
+  fmt::println("-- 创建并销毁 {} 个 Object:", kObjects);
+  auto create = [&](const char *name, auto make)
+  {
+    bench::report(name, bench::nsPerOp(kObjects, [&]
+                                       {
+                                         for (int i = 0; i < kObjects; ++i) bench::doNotOptimize(make(i));
+                                       }));
+  };
+  create("shared_ptr<Object>(new Object)", [](int i)
+         { return std::shared_ptr<Object>(new Object(i)); });
+  create("make_shared<Object>", [](int i)
+         { return std::make_shared<Object>(i); });
+  create("make_intrusive<RcObject> (atomic)", [](int i)
+         { return make_intrusive<RcObject>(i); });
+  create("make_intrusive<LocalRcObject>", [](int i)
+         { return make_intrusive<LocalRcObject>(i); });
+
+  fmt::println("-- 拷贝并销毁 {} 次指针:", kCopies);
+  auto copy = [&](const char *name, const auto &ptr)
+  {
+    bench::report(name, bench::nsPerOp(kCopies, [&]
+                                       {
+                                         for (int i = 0; i < kCopies; ++i)
+                                         {
+                                           auto c = ptr;
+                                           bench::doNotOptimize(c);
+                                         }
+                                       }));
+  };
+  copy("shared_ptr<Object>", std::make_shared<Object>(1));
+  copy("intrusive_ptr<RcObject> (atomic)", make_intrusive<RcObject>(1));
+  copy("intrusive_ptr<LocalRcObject>", make_intrusive<LocalRcObject>(1));
+
+  // 注意: libstdc++ 在进程还没有创建过线程时, shared_ptr 会偷偷使用非原子计数(__libc_single_threaded),
+  // 一旦创建过线程就永久切换为原子操作. 真实服务都是多线程的, 下面这一行才是它的实际开销.
+  std::thread([] {}).join();
+  copy("shared_ptr<Object> (after a thread ran)", std::make_shared<Object>(1));
+  Object::verbose = true;
+}
+
+/// @brief 用于遍历测试的二叉树节点, Ptr 为节点之间使用的智能指针
+template <template <typename> class Ptr>
+struct GraphNode
+{
+  int value = 0;
+  std::vector<Ptr<GraphNode>> children;
+};
+
+/// @brief 按层构造一棵完全二叉树, 返回根节点
+template <template <typename> class Ptr, typename Make>
+Ptr<GraphNode<Ptr>> buildTree(int count, Make make)
+{
+  std::vector<Ptr<GraphNode<Ptr>>> nodes;
+  nodes.reserve(static_cast<std::size_t>(count));
+  for (int i = 0; i < count; ++i)
+  {
+    nodes.push_back(make());
+    nodes.back()->value = i;
+  }
+  for (int i = 0; i < count; ++i)
+  {
+    for (int c = 2 * i + 1; c <= 2 * i + 2 && c < count; ++c) nodes[i]->children.push_back(nodes[c]);
+  }
+  return nodes.front();
+}
+
+/// @brief 深度优先遍历, 栈中保存的是智能指针的拷贝: 每访问一个节点至少一次拷贝和一次销毁
+template <typename NodePtr>
+long long traverse(const NodePtr &root)
+{
+  long long sum = 0;
+  std::vector<NodePtr> stack{root};
+  while (!stack.empty())
+  {
+    NodePtr node = std::move(stack.back());
+    stack.pop_back();
+    sum += node->value;
+    for (const auto &child : node->children) stack.push_back(child);
+  }
+  return sum;
+}
+
+/// @brief 引用计数密集的对象图遍历: shared_ptr vs local_shared_ptr
+void benchLocalShared()
+{
+  constexpr int kNodes = 1'000'000;
+  constexpr int kRounds = 5;
+  fmt::println("========== benchmark: graph traversal, {} nodes x {} rounds ==========", kNodes, kRounds);
+
+  auto shared_root = buildTree<std::shared_ptr>(kNodes, [] { return std::make_shared<GraphNode<std::shared_ptr>>(); });
+  auto local_root =
+    buildTree<local_shared_ptr>(kNodes, [] { return make_local_shared<GraphNode<local_shared_ptr>>(); });
+
+  auto run = [&](const char *name, const auto &root)
+  {
+    long long sum = 0;
+    bench::report(name, bench::nsPerOp(static_cast<std::size_t>(kNodes) * kRounds, [&]
+                                       {
+                                         for (int r = 0; r < kRounds; ++r) sum += traverse(root);
+                                       }));
+    bench::doNotOptimize(sum);
+  };
+  run("shared_ptr (atomic)", shared_root);
+  run("local_shared_ptr (plain counter)", local_root);
+}
+
+/// @brief 打印全局堆的使用情况(依赖 glibc 2.33+ 的 mallinfo2, 其他平台只打印内存池统计)
+void printHeapStats(const char *title)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+  fmt::println("  {:<28} heap = {:>7.1f} MB, in use = {:>7.1f} MB, free = {:>7.1f} MB, free chunks = {}", title,
+               static_cast<double>(mi.arena) / 1e6, static_cast<double>(mi.uordblks) / 1e6,
+               static_cast<double>(mi.fordblks) / 1e6, mi.ordblks + mi.smblks);
+#else
+  fmt::println("  {:<28} (堆统计需要 glibc mallinfo2)", title);
+#endif
+}
+
+/// @brief make_shared vs allocate_shared + 线程局部内存池
+void benchPooled()
+{
+  constexpr int kOps = 10'000'000;
+  constexpr int kLive = 1'000'000;
+  fmt::println("========== benchmark: make_shared vs allocate_shared(pool_allocator) ==========");
+  Object::verbose = false;
+
+  fmt::println("-- 创建并销毁 {} 个 shared_ptr<Object>:", kOps);
+  bench::report("make_shared<Object>", bench::nsPerOp(kOps, []
+                                                      {
+                                                        for (int i = 0; i < kOps; ++i)
+                                                          bench::doNotOptimize(std::make_shared<Object>(i));
+                                                      }));
+  bench::report("make_pooled<Object>", bench::nsPerOp(kOps, []
+                                                      {
+                                                        for (int i = 0; i < kOps; ++i)
+                                                          bench::doNotOptimize(make_pooled<Object>(i));
+                                                      }));
+
+  // 碎片: 保持 kLive 个对象存活, 随机释放一半, 观察堆中留下的空洞
+  fmt::println("-- {} 个对象存活后随机释放一半:", kLive);
+  std::vector<int> order(kLive);
+  for (int i = 0; i < kLive; ++i) order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+  auto fragment = [&](const char *title, auto make)
+  {
+    std::vector<std::shared_ptr<Object>> live;
+    live.reserve(kLive);
+    for (int i = 0; i < kLive; ++i) live.push_back(make(i));
+    for (int i = 0; i < kLive / 2; ++i) live[order[i]].reset();
+    printHeapStats(title);
+  };
+  printHeapStats("baseline");
+  fragment("make_shared", [](int i) { return std::make_shared<Object>(i); });
+  fragment("make_pooled", [](int i) { return make_pooled<Object>(i); });
+  const auto &stats = pool_resource::local().stats();
+  fmt::println("  pool: chunks = {}, reserved = {:.1f} MB, in use blocks = {}, free blocks = {}", stats.chunks,
+               static_cast<double>(stats.reserved_bytes) / 1e6, stats.in_use_blocks, stats.free_blocks);
+  Object::verbose = true;
+}
+
+/// @brief 热点配置: 读线程频繁读取, 写线程偶尔整体替换
+struct Config : intrusive_ref_counter<Config>
+{
+  int version = 0;
+  std::string name;
+  Config(int v, std::string n) : version(v), name(std::move(n)) {}
+};
+
+void test06()
+{
+  atomic_shared_ptr<Config> config(make_intrusive<Config>(1, "v1"));
+  intrusive_ptr<Config> current = config.load();  // 无锁读取, 得到的指针可以长期持有
+  fmt::println("load: version = {}, name = {}", current->version, current->name);
+
+  config.store(make_intrusive<Config>(2, "v2"));  // 替换后旧配置仍被 current 持有
+  fmt::println("old config still alive: version = {}, use_count = {}", current->version, current->use_count());
+
+  intrusive_ptr<Config> expected = current;  // 已经过期的值, CAS 失败并得到最新值
+  bool ok = config.compare_exchange_strong(expected, make_intrusive<Config>(3, "v3"));
+  fmt::println("CAS with stale value: {}, expected.version = {}", ok, expected->version);
+  ok = config.compare_exchange_strong(expected, make_intrusive<Config>(3, "v3"));
+  fmt::println("CAS with latest value: {}, version = {}", ok, config.load()->version);
+}
+
+/// @brief 本地计数反复越过补充阈值(kBatch / 2): 持有 3 * kBatch 个 load() 的结果,
+/// 每次 load 领走的引用都必须被计入全局计数, exchange 之后引用计数正好是持有者的个数
+void test07()
+{
+  using Ptr = atomic_shared_ptr<Config>;
+  constexpr std::size_t kLoads = 3 * Ptr::kBatch;
+  Ptr config(make_intrusive<Config>(1, "v1"));
+  std::vector<intrusive_ptr<Config>> held;
+  held.reserve(kLoads);
+  for (std::size_t i = 0; i < kLoads; ++i) held.push_back(config.load());
+
+  intrusive_ptr<Config> old = config.exchange(make_intrusive<Config>(2, "v2"));
+  int errors = old->use_count() == kLoads + 1 ? 0 : 1;  // held 中的 kLoads 个 + old
+  held.clear();
+  errors += old->use_count() == 1 ? 0 : 1;
+  errors += config.load()->use_count() == Ptr::kBatch ? 0 : 1;  // 新指针的全局计数就是预付的 kBatch 个, 临时变量领走的那一个也在其中
+  fmt::println("atomic_shared_ptr: {} loads across the replenish threshold, use_count = {}, errors = {}", kLoads,
+               old->use_count(), errors);
+}
+
+/// @brief 多个读线程读取配置, 一个写线程每 100us 替换一次配置, 返回读操作的平均耗时(ns)
+template <typename Read, typename Write>
+double readHotConfig(unsigned readers, std::size_t ops_per_reader, Read read, Write write)
+{
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < readers; ++t)
+  {
+    threads.emplace_back(
+      [&]
+      {
+        long long sum = 0;
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        for (std::size_t i = 0; i < ops_per_reader; ++i) sum += read();
+        bench::doNotOptimize(sum);
+      });
+  }
+  std::thread writer(
+    [&]
+    {
+      for (int version = 1; !stop.load(std::memory_order_relaxed); ++version)
+      {
+        write(version);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    });
+  double ns = bench::nsPerOp(readers * ops_per_reader,
+                             [&]
+                             {
+                               go.store(true, std::memory_order_release);
+                               for (auto &t : threads) t.join();
+                             });
+  stop.store(true, std::memory_order_relaxed);
+  writer.join();
+  return ns;
+}
+
+/// @brief 对比三种跨线程共享 "热点配置指针" 的方式的读性能
+void benchAtomicShared()
+{
+  constexpr std::size_t kOps = 2'000'000;
+  const unsigned readers = std::min(8U, std::max(4U, std::thread::hardware_concurrency()));
+  fmt::println("========== benchmark: hot config pointer, {} readers x {} loads ==========", readers, kOps);
+
+  std::shared_mutex mutex;
+  std::shared_ptr<Config> locked_config = std::make_shared<Config>(0, "config");
+  bench::report("shared_mutex + shared_ptr",
+                readHotConfig(
+                  readers, kOps,
+                  [&]
+                  {
+                    std::shared_lock<std::shared_mutex> lock(mutex);
+                    std::shared_ptr<Config> copy = locked_config;
+                    lock.unlock();
+                    return copy->version;
+                  },
+                  [&](int version)
+                  {
+                    auto fresh = std::make_shared<Config>(version, "config");
+                    std::unique_lock<std::shared_mutex> lock(mutex);
+                    locked_config.swap(fresh);
+                  }));
+
+  std::shared_ptr<Config> free_config = std::make_shared<Config>(0, "config");
+  bench::report("std::atomic_load(shared_ptr)",
+                readHotConfig(
+                  readers, kOps, [&] { return std::atomic_load(&free_config)->version; },
+                  [&](int version) { std::atomic_store(&free_config, std::make_shared<Config>(version, "config")); }));
+
+  atomic_shared_ptr<Config> split_config(make_intrusive<Config>(0, "config"));
+  bench::report("atomic_shared_ptr (split count)",
+                readHotConfig(
+                  readers, kOps, [&] { return split_config.load()->version; },
+                  [&](int version) { split_config.store(make_intrusive<Config>(version, "config")); }));
+}
+
 int main()
 {
   test01();
@@ -102,8 +458,16 @@ int main()
   fmt::println("---------------------------------------------------");
   test03();
   fmt::println("---------------------------------------------------");
-  // test04();
+  test04();
+  fmt::println("---------------------------------------------------");
+  test05();
+  fmt::println("---------------------------------------------------");
+  test06();
   fmt::println("---------------------------------------------------");
-  // test05();
+  test07();
   fmt::println("---------------------------------------------------");
+  benchIntrusive();
+  benchLocalShared();  // 在 benchIntrusive 创建过线程之后运行, shared_ptr 已经是原子计数
+  benchPooled();
+  benchAtomicShared();
 }
\ No newline at end of file
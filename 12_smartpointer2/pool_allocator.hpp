@@ -0,0 +1,166 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * 内存池 + allocate_shared.
+ *
+ * make_shared 每次都向全局堆申请 "控制块 + 对象" 大小的内存, 大量创建/销毁时 malloc 的开销和堆碎片都很明显.
+ * std::allocate_shared 允许传入自定义分配器, 控制块和对象仍然一次分配, 只是内存来自我们的内存池:
+ *   - pool_resource: 按大小分级(16, 32, ... 256 字节)的空闲链表, 每次向系统申请一大块(chunk)再切分, 不是线程安全的.
+ *   - pool_allocator<T>: 满足标准 Allocator 要求的轻量分配器, 只保存 pool_resource 指针, 可以 rebind 到控制块类型.
+ *   - make_pooled<T>(args...): 使用当前线程的 pool_resource 调用 allocate_shared.
+ *
+ * 注意: 控制块中保存了分配器(即 pool_resource 指针), 最后一个 shared_ptr 释放时内存回到创建它的那个内存池.
+ * 因此 make_pooled 创建的对象必须在创建它的线程内释放; 需要跨线程时请自己创建 pool_resource 并加锁.
+ */
+class pool_resource
+{
+ public:
+  static constexpr std::size_t kGranularity = 16;  // 大小级别的间隔, 也是块的对齐
+  static constexpr std::size_t kMaxBlockSize = 256;  // 超过这个大小直接使用 operator new
+  static constexpr std::size_t kChunkSize = 64 * 1024;
+
+  /// @brief 内存池的统计信息
+  struct Stats
+  {
+    std::size_t chunks = 0;         // 向系统申请的大块数量
+    std::size_t reserved_bytes = 0;  // 向系统申请的总字节数
+    std::size_t in_use_blocks = 0;   // 正在使用的块数量
+    std::size_t free_blocks = 0;     // 空闲链表中的块数量
+  };
+
+  pool_resource() = default;
+  pool_resource(const pool_resource &) = delete;
+  pool_resource &operator=(const pool_resource &) = delete;
+  ~pool_resource()
+  {
+    // 还有块没有归还时不释放 chunk, 宁可泄漏也不能让存活的对象指向已释放的内存
+    if (stats_.in_use_blocks != 0) return;
+    for (void *chunk : chunks_) ::operator delete(chunk);
+  }
+
+  /// @brief 当前线程的内存池
+  static pool_resource &local()
+  {
+    thread_local pool_resource pool;
+    return pool;
+  }
+
+  void *allocate(std::size_t bytes, std::size_t alignment)
+  {
+    if (bytes > kMaxBlockSize || alignment > kGranularity) return ::operator new(bytes, std::align_val_t{alignment});
+    FreeBlock *&head = free_lists_[classIndex(bytes)];
+    if (head == nullptr) refill(classIndex(bytes));
+    FreeBlock *block = head;
+    head = block->next;
+    --stats_.free_blocks;
+    ++stats_.in_use_blocks;
+    return block;
+  }
+
+  void deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+  {
+    if (bytes > kMaxBlockSize || alignment > kGranularity)
+    {
+      ::operator delete(p, std::align_val_t{alignment});
+      return;
+    }
+    FreeBlock *&head = free_lists_[classIndex(bytes)];
+    head = ::new (p) FreeBlock{head};
+    ++stats_.free_blocks;
+    --stats_.in_use_blocks;
+  }
+
+  [[nodiscard]] const Stats &stats() const noexcept
+  {
+    return stats_;
+  }
+
+ private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  static constexpr std::size_t kClassCount = kMaxBlockSize / kGranularity;
+
+  static constexpr std::size_t classIndex(std::size_t bytes) noexcept
+  {
+    return bytes == 0 ? 0 : (bytes - 1) / kGranularity;
+  }
+
+  /// @brief 申请一个 chunk 并全部切分成指定大小级别的块
+  void refill(std::size_t index)
+  {
+    const std::size_t block_size = (index + 1) * kGranularity;
+    chunks_.reserve(chunks_.size() + 1);
+    auto *chunk = static_cast<std::byte *>(::operator new(kChunkSize));
+    chunks_.push_back(chunk);
+    ++stats_.chunks;
+    stats_.reserved_bytes += kChunkSize;
+    const std::size_t count = kChunkSize / block_size;
+    FreeBlock *&head = free_lists_[index];
+    for (std::size_t i = count; i > 0; --i) head = ::new (chunk + (i - 1) * block_size) FreeBlock{head};
+    stats_.free_blocks += count;
+  }
+
+  FreeBlock *free_lists_[kClassCount] = {};
+  std::vector<void *> chunks_;
+  Stats stats_;
+};
+
+template <typename T>
+class pool_allocator
+{
+ public:
+  using value_type = T;
+
+  explicit pool_allocator(pool_resource &resource = pool_resource::local()) noexcept : resource_(&resource) {}
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U> &other) noexcept : resource_(other.resource())  // NOLINT
+  {
+  }
+
+  T *allocate(std::size_t n)
+  {
+    return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept
+  {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] pool_resource *resource() const noexcept
+  {
+    return resource_;
+  }
+
+ private:
+  pool_resource *resource_;
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T> &a, const pool_allocator<U> &b) noexcept
+{
+  return a.resource() == b.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T> &a, const pool_allocator<U> &b) noexcept
+{
+  return a.resource() != b.resource();
+}
+
+/// @brief 控制块和对象一起放在当前线程的内存池中
+template <typename T, typename... Args>
+std::shared_ptr<T> make_pooled(Args &&...args)
+{
+  return std::allocate_shared<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
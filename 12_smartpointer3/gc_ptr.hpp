@@ -0,0 +1,424 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * gc_ptr: 带环检测的引用计数智能指针(试删除 / trial deletion 算法, Bacon & Rajan 2001).
+ *
+ * 普通引用计数无法回收循环引用(见 test01 中的 A/B), weak_ptr 需要人工判断哪一方是 "从属" 的.
+ * 对象图很大时无法逐个审核所有反向指针, 这里提供一个可选的环回收器:
+ *   1. 引用计数减到 0 时立即释放(与 shared_ptr 相同).
+ *   2. 引用计数减到非 0 时, 对象 "可能是某个环的根", 被记录到候选根缓冲区(紫色).
+ *   3. collect() 从候选根出发做试删除:
+ *        MarkGray : 沿着子对象把内部边的计数减掉(试删除).
+ *        Scan     : 计数仍 > 0 的对象被外部引用, 恢复它及其可达对象的计数(ScanBlack); 否则标记为白色.
+ *        Collect  : 白色对象就是只被环内部引用的垃圾, 统一析构并释放.
+ *   4. 增量回收: collect(work_budget) 每次只处理一部分候选根, 访问的节点数超过预算就停下, 停顿时间有上界.
+ *      (上界是 预算 + 最后一个根可达的子图大小, 单个超大的环仍需要一次完整遍历.)
+ *
+ * 使用方法: 对象继承 gc_object, 在 trace() 中把所有 gc_ptr 成员交给 tracer; 用 make_gc<T>() 创建对象.
+ * 限制: 回收器不是线程安全的, 所有 gc_ptr 及其对象只能在一个线程中使用.
+ */
+
+class gc_object;
+class cycle_collector;
+
+namespace detail
+{
+enum class gc_color : unsigned char
+{
+  black,    // 正在使用
+  gray,     // 试删除中
+  white,    // 垃圾
+  purple,   // 可能是环的根
+  freeing,  // 正在被回收器释放
+};
+
+/// @brief 对象头: 与对象一起分配, 但生命周期比对象本身稍长, 回收时对象析构后仍可以安全地读取颜色
+struct gc_header
+{
+  std::size_t rc = 1;
+  std::size_t buffer_index = std::numeric_limits<std::size_t>::max();  // 在候选根缓冲区中的位置
+  gc_color color = gc_color::black;
+  gc_object *object = nullptr;
+  void (*deallocate)(gc_header *) = nullptr;
+
+  [[nodiscard]] bool buffered() const noexcept
+  {
+    return buffer_index != std::numeric_limits<std::size_t>::max();
+  }
+};
+
+template <typename T>
+struct gc_box : gc_header
+{
+  alignas(T) unsigned char storage[sizeof(T)];
+};
+
+void incRef(gc_header *h) noexcept;
+void decRef(gc_header *h) noexcept;
+}  // namespace detail
+
+/// @brief 在 gc_object::trace() 中收集子对象
+class gc_tracer
+{
+ public:
+  explicit gc_tracer(std::vector<detail::gc_header *> &out) : out_(&out) {}
+
+  template <typename Ptr>
+  void operator()(const Ptr &ptr) const
+  {
+    if (ptr) out_->push_back(ptr.header());
+  }
+
+ private:
+  std::vector<detail::gc_header *> *out_;
+};
+
+/// @brief 可以被 gc_ptr 管理的对象基类
+class gc_object
+{
+ public:
+  gc_object() = default;
+  gc_object(const gc_object &) = default;
+  gc_object &operator=(const gc_object &) = default;
+  virtual ~gc_object() = default;
+
+  /// @brief 把所有 gc_ptr 成员交给 tracer
+  virtual void trace(const gc_tracer &tracer) const = 0;
+};
+
+template <typename T>
+class gc_ptr
+{
+ public:
+  constexpr gc_ptr() noexcept = default;
+
+  gc_ptr(const gc_ptr &other) noexcept : ptr_(other.ptr_), header_(other.header_)
+  {
+    if (header_ != nullptr) detail::incRef(header_);
+  }
+
+  gc_ptr(gc_ptr &&other) noexcept :
+    ptr_(std::exchange(other.ptr_, nullptr)), header_(std::exchange(other.header_, nullptr))
+  {
+  }
+
+  template <typename U>
+  gc_ptr(const gc_ptr<U> &other) noexcept : ptr_(other.get()), header_(other.header())  // NOLINT
+  {
+    if (header_ != nullptr) detail::incRef(header_);
+  }
+
+  ~gc_ptr()
+  {
+    if (header_ != nullptr) detail::decRef(header_);
+  }
+
+  gc_ptr &operator=(const gc_ptr &other) noexcept
+  {
+    gc_ptr(other).swap(*this);
+    return *this;
+  }
+
+  gc_ptr &operator=(gc_ptr &&other) noexcept
+  {
+    gc_ptr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept
+  {
+    gc_ptr().swap(*this);
+  }
+
+  void swap(gc_ptr &other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+    std::swap(header_, other.header_);
+  }
+
+  [[nodiscard]] T *get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T *operator->() const noexcept
+  {
+    return ptr_;
+  }
+
+  T &operator*() const noexcept
+  {
+    return *ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+  [[nodiscard]] detail::gc_header *header() const noexcept
+  {
+    return header_;
+  }
+
+  [[nodiscard]] std::size_t use_count() const noexcept
+  {
+    return header_ != nullptr ? header_->rc : 0;
+  }
+
+ private:
+  template <typename U, typename... Args>
+  friend gc_ptr<U> make_gc(Args &&...args);
+
+  gc_ptr(T *p, detail::gc_header *h) noexcept : ptr_(p), header_(h) {}
+
+  T *ptr_ = nullptr;
+  detail::gc_header *header_ = nullptr;
+};
+
+/// @brief 环回收器(每个进程一个, 单线程使用)
+class cycle_collector
+{
+ public:
+  /// @brief 一次 collect() 的统计
+  struct Result
+  {
+    std::size_t roots = 0;    // 处理的候选根数量
+    std::size_t visited = 0;  // 试删除访问的节点数量
+    std::size_t freed = 0;    // 回收的对象数量
+  };
+
+  static cycle_collector &instance()
+  {
+    static cycle_collector collector;
+    return collector;
+  }
+
+  /// @brief 回收一部分候选根, 访问节点数达到 work_budget 后停止; 默认处理全部候选根
+  Result collect(std::size_t work_budget = std::numeric_limits<std::size_t>::max())
+  {
+    Result result;
+    batch_.clear();
+    // 1. MarkGray: 按预算取出一批候选根做试删除
+    while (!roots_.empty() && result.visited < work_budget)
+    {
+      detail::gc_header *s = roots_.back();
+      roots_.pop_back();
+      s->buffer_index = kNotBuffered;
+      ++result.roots;
+      if (s->color == detail::gc_color::purple)
+      {
+        result.visited += markGray(s);
+        batch_.push_back(s);
+      }
+    }
+    // 2. Scan: 被外部引用的恢复为黑色, 其余标记为白色
+    for (detail::gc_header *s : batch_) scan(s);
+    // 3. Collect: 收集白色对象
+    garbage_.clear();
+    for (detail::gc_header *s : batch_) collectWhite(s);
+    result.freed = garbage_.size();
+    freeGarbage();
+    return result;
+  }
+
+  [[nodiscard]] std::size_t pendingRoots() const noexcept
+  {
+    return roots_.size();
+  }
+
+ private:
+  friend void detail::decRef(detail::gc_header *h) noexcept;
+
+  static constexpr std::size_t kNotBuffered = std::numeric_limits<std::size_t>::max();
+
+  void possibleRoot(detail::gc_header *h)
+  {
+    if (h->color == detail::gc_color::purple) return;
+    h->color = detail::gc_color::purple;
+    if (!h->buffered())
+    {
+      h->buffer_index = roots_.size();
+      roots_.push_back(h);
+    }
+  }
+
+  /// @brief 从候选根缓冲区中删除(与最后一个交换), O(1)
+  void removeRoot(detail::gc_header *h) noexcept
+  {
+    if (!h->buffered()) return;
+    detail::gc_header *last = roots_.back();
+    roots_[h->buffer_index] = last;
+    last->buffer_index = h->buffer_index;
+    roots_.pop_back();
+    h->buffer_index = kNotBuffered;
+  }
+
+  /// @brief 计数归零, 正常释放
+  void release(detail::gc_header *h) noexcept
+  {
+    removeRoot(h);
+    h->color = detail::gc_color::freeing;
+    h->object->~gc_object();
+    h->deallocate(h);
+  }
+
+  void children(detail::gc_header *h)
+  {
+    children_.clear();
+    h->object->trace(gc_tracer(children_));
+  }
+
+  std::size_t markGray(detail::gc_header *s)
+  {
+    std::size_t visited = 0;
+    s->color = detail::gc_color::gray;
+    stack_.push_back(s);
+    while (!stack_.empty())
+    {
+      detail::gc_header *u = stack_.back();
+      stack_.pop_back();
+      ++visited;
+      children(u);
+      for (detail::gc_header *t : children_)
+      {
+        --t->rc;  // 试删除内部边
+        if (t->color != detail::gc_color::gray)
+        {
+          t->color = detail::gc_color::gray;
+          stack_.push_back(t);
+        }
+      }
+    }
+    return visited;
+  }
+
+  void scan(detail::gc_header *s)
+  {
+    stack_.push_back(s);
+    while (!stack_.empty())
+    {
+      detail::gc_header *u = stack_.back();
+      stack_.pop_back();
+      if (u->color != detail::gc_color::gray) continue;
+      if (u->rc > 0)
+      {
+        scanBlack(u);
+        continue;
+      }
+      u->color = detail::gc_color::white;
+      children(u);
+      stack_.insert(stack_.end(), children_.begin(), children_.end());
+    }
+  }
+
+  /// @brief 恢复 s 及其可达对象的计数
+  void scanBlack(detail::gc_header *s)
+  {
+    s->color = detail::gc_color::black;
+    black_stack_.push_back(s);
+    while (!black_stack_.empty())
+    {
+      detail::gc_header *u = black_stack_.back();
+      black_stack_.pop_back();
+      children(u);
+      for (detail::gc_header *t : children_)
+      {
+        ++t->rc;
+        if (t->color != detail::gc_color::black)
+        {
+          t->color = detail::gc_color::black;
+          black_stack_.push_back(t);
+        }
+      }
+    }
+  }
+
+  void collectWhite(detail::gc_header *s)
+  {
+    stack_.push_back(s);
+    while (!stack_.empty())
+    {
+      detail::gc_header *u = stack_.back();
+      stack_.pop_back();
+      if (u->color != detail::gc_color::white) continue;
+      u->color = detail::gc_color::freeing;
+      garbage_.push_back(u);
+      children(u);
+      stack_.insert(stack_.end(), children_.begin(), children_.end());
+    }
+  }
+
+  void freeGarbage()
+  {
+    // 垃圾指向存活对象的边在 MarkGray 中已经减过一次, 先加回来, 析构时 gc_ptr 会正常地再减一次
+    for (detail::gc_header *g : garbage_)
+    {
+      children(g);
+      for (detail::gc_header *t : children_)
+        if (t->color != detail::gc_color::freeing) ++t->rc;
+    }
+    // 先析构全部对象, 再统一释放内存: 析构过程中垃圾之间互相 decRef 时对象头仍然有效(颜色为 freeing, 直接忽略)
+    for (detail::gc_header *g : garbage_)
+    {
+      removeRoot(g);
+      g->object->~gc_object();
+    }
+    for (detail::gc_header *g : garbage_) g->deallocate(g);
+  }
+
+  std::vector<detail::gc_header *> roots_;
+  std::vector<detail::gc_header *> batch_;
+  std::vector<detail::gc_header *> garbage_;
+  std::vector<detail::gc_header *> stack_;
+  std::vector<detail::gc_header *> black_stack_;
+  std::vector<detail::gc_header *> children_;
+};
+
+namespace detail
+{
+inline void incRef(gc_header *h) noexcept
+{
+  ++h->rc;
+  if (h->color == gc_color::purple) h->color = gc_color::black;
+}
+
+inline void decRef(gc_header *h) noexcept
+{
+  if (h->color == gc_color::freeing) return;  // 回收器正在释放这个对象
+  if (--h->rc == 0)
+    cycle_collector::instance().release(h);
+  else
+    cycle_collector::instance().possibleRoot(h);
+}
+}  // namespace detail
+
+/// @brief 创建由 gc_ptr 管理的对象, 对象头和对象一次分配
+template <typename T, typename... Args>
+gc_ptr<T> make_gc(Args &&...args)
+{
+  static_assert(std::is_base_of_v<gc_object, T>, "T 必须派生自 gc_object");
+  auto *box = new detail::gc_box<T>;
+  T *object = nullptr;
+  try
+  {
+    object = ::new (static_cast<void *>(box->storage)) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    delete box;
+    throw;
+  }
+  box->object = object;
+  box->deallocate = [](detail::gc_header *h)
+  {
+    delete static_cast<detail::gc_box<T> *>(h);
+  };
+  return gc_ptr<T>(object, box);
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * 风险指针(hazard pointer): 无锁读取共享对象时的内存回收方案.
+ *
+ * 读线程:  p = src.load(); hazard = p; 再次读取 src 确认 p 没有被替换 -> 之后可以安全地访问 *p, 直到清除 hazard.
+ * 写线程:  old = src.exchange(新对象); retire(old) -> old 先放进本线程的待回收列表,
+ *          列表足够长时扫描所有线程的 hazard, 没有被任何读线程保护的对象才真正删除.
+ * 读路径上没有引用计数, 没有 CAS, 只有一次 hazard 写入和一次确认读取, 多个读线程之间不会竞争同一个缓存行.
+ *
+ * 这里的实现是一个进程级的 hazard_domain:
+ *   - 最多 kMaxThreads 个线程同时使用, 每个线程 kSlotsPerThread 个 hazard 槽位(即同时持有的保护指针数量).
+ *   - 线程第一次使用时领取一条记录, 线程退出时归还, 未回收完的对象交给 domain 统一处理.
+ */
+class hazard_domain
+{
+ public:
+  static constexpr std::size_t kMaxThreads = 128;
+  static constexpr std::size_t kSlotsPerThread = 4;
+  static constexpr std::size_t kScanThreshold = 2 * kMaxThreads * kSlotsPerThread;  // 待回收数量超过它时扫描
+
+  using deleter_type = void (*)(void *);
+
+ private:
+  struct Record;
+
+ public:
+  /// @brief 领取到的 hazard 槽位: 记录所属的线程记录和下标, 归还时直接作用在这条记录上,
+  /// 因此持有者被移动到其他线程后再归还也不会清错线程的槽位
+  struct slot
+  {
+    Record *record = nullptr;
+    std::size_t index = 0;
+
+    [[nodiscard]] std::atomic<void *> &hazard() const noexcept;
+    explicit operator bool() const noexcept
+    {
+      return record != nullptr;
+    }
+  };
+
+  hazard_domain(const hazard_domain &) = delete;
+  hazard_domain &operator=(const hazard_domain &) = delete;
+  ~hazard_domain()
+  {
+    // 进程退出时所有读线程都已经结束, 直接释放剩下的对象
+    for (const Retired &r : orphans_) r.deleter(r.ptr);
+  }
+
+  static hazard_domain &instance()
+  {
+    static hazard_domain domain;
+    return domain;
+  }
+
+  /// @brief 领取当前线程的一个空闲 hazard 槽位
+  slot acquireSlot()
+  {
+    // 只有所属线程会领取槽位, 其他线程只会把槽位清空, 所以这里用普通的读写即可, 不需要 CAS
+    Record *record = local().record;
+    for (std::size_t i = 0; i < kSlotsPerThread; ++i)
+    {
+      if (record->hazards[i].load(std::memory_order_acquire) == nullptr)
+      {
+        record->hazards[i].store(&reserved_tag_, std::memory_order_relaxed);
+        return {record, i};
+      }
+    }
+    assert(false && "同时持有的 hazard 指针超过 kSlotsPerThread");
+    throw std::bad_alloc{};
+  }
+
+  /// @brief 清除 hazard 并归还槽位, 可以在任意线程调用
+  static void releaseSlot(slot s) noexcept
+  {
+    s.hazard().store(nullptr, std::memory_order_release);
+  }
+
+  /// @brief 延迟删除: 等到没有任何 hazard 指向 ptr 时再调用 deleter
+  void retire(void *ptr, deleter_type deleter)
+  {
+    ThreadState &state = local();
+    state.retired.push_back({ptr, deleter});
+    if (state.retired.size() >= kScanThreshold) scan(state.retired);
+  }
+
+  /// @brief 立即扫描一次当前线程的待回收列表
+  void reclaim()
+  {
+    scan(local().retired);
+  }
+
+ private:
+  struct alignas(64) Record  // 每个线程独占一个缓存行, 发布 hazard 时不会互相干扰
+  {
+    std::atomic<bool> active{false};
+    // 空指针表示槽位空闲, 已领取但还没有保护对象的槽位存放 reserved_tag_.
+    // 线程退出时仍被占用的槽位保持占用, 接手这条记录的新线程不会复用它们
+    std::atomic<void *> hazards[kSlotsPerThread] = {};
+  };
+
+  struct Retired
+  {
+    void *ptr;
+    deleter_type deleter;
+  };
+
+  /// @brief 线程私有状态, 线程退出时归还记录
+  struct ThreadState
+  {
+    hazard_domain *domain;
+    Record *record;
+    std::vector<Retired> retired;
+
+    explicit ThreadState(hazard_domain &d) : domain(&d), record(d.acquireRecord()) {}
+    ThreadState(const ThreadState &) = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+    ~ThreadState()
+    {
+      domain->scan(retired);
+      if (!retired.empty())
+      {
+        std::lock_guard<std::mutex> lock(domain->orphans_mutex_);
+        domain->orphans_.insert(domain->orphans_.end(), retired.begin(), retired.end());
+      }
+      record->active.store(false, std::memory_order_release);
+    }
+  };
+
+  hazard_domain() = default;  // 只能通过 instance() 取得进程唯一的 domain
+
+  ThreadState &local()
+  {
+    thread_local ThreadState state(*this);
+    return state;
+  }
+
+  Record *acquireRecord()
+  {
+    for (Record &r : records_)
+    {
+      bool expected = false;
+      if (!r.active.load(std::memory_order_relaxed) &&
+          r.active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return &r;
+    }
+    assert(false && "使用 hazard 指针的线程数超过 kMaxThreads");
+    throw std::bad_alloc{};
+  }
+
+  /// @brief 删除没有被任何 hazard 保护的对象
+  void scan(std::vector<Retired> &retired)
+  {
+    {
+      // 顺便接手已退出线程留下的对象
+      std::unique_lock<std::mutex> lock(orphans_mutex_, std::try_to_lock);
+      if (lock.owns_lock() && !orphans_.empty())
+      {
+        retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+        orphans_.clear();
+      }
+    }
+    std::vector<void *> protected_ptrs;
+    protected_ptrs.reserve(kMaxThreads * kSlotsPerThread);
+    for (const Record &r : records_)
+    {
+      for (const auto &h : r.hazards)
+      {
+        // 与读线程 "写 hazard -> 再读源指针" 配对: 写线程已经替换了源指针, 这里必须看到已发布的 hazard
+        void *p = h.load(std::memory_order_seq_cst);
+        if (p != nullptr) protected_ptrs.push_back(p);
+      }
+    }
+    std::sort(protected_ptrs.begin(), protected_ptrs.end());
+    auto keep = std::partition(retired.begin(), retired.end(), [&](const Retired &r)
+                               { return std::binary_search(protected_ptrs.begin(), protected_ptrs.end(), r.ptr); });
+    for (auto it = keep; it != retired.end(); ++it) it->deleter(it->ptr);
+    retired.erase(keep, retired.end());
+  }
+
+  static inline char reserved_tag_ = 0;  // 只用它的地址, 不会被 retire, 出现在扫描结果中也没有影响
+
+  Record records_[kMaxThreads];
+  std::mutex orphans_mutex_;
+  std::vector<Retired> orphans_;
+};
+
+inline std::atomic<void *> &hazard_domain::slot::hazard() const noexcept
+{
+  return record->hazards[index];
+}
@@ -1,7 +1,18 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "gc_ptr.hpp"
+#include "observer_table.hpp"
 
 /**
  * weak_ptr：不增加强引用计数，仅观察对象是否存在。需要配合shared_ptr使用.
@@ -130,6 +141,265 @@ void test03()
     wp.expired());  // 如果 weak_ptr 观察的对象仍然存在，expired() 返回 false；如果对象已经被释放，expired() 返回 true。
 }
 
+/**
+ * gc_ptr: 不需要区分强弱引用, 双方都持有 gc_ptr, 形成的环由 cycle_collector 回收.
+ * 适合对象图很大, 无法逐个确认哪个指针应该是 weak_ptr 的场景.
+ */
+struct GcB;
+struct GcA : gc_object
+{
+  gc_ptr<GcB> ptrB;
+  GcA() = default;
+  GcA(const GcA &) = delete;
+  GcA &operator=(const GcA &) = delete;
+  ~GcA() override
+  {
+    fmt::print("GcA destroyed\n");
+  }
+  void trace(const gc_tracer &tracer) const override
+  {
+    tracer(ptrB);
+  }
+};
+
+struct GcB : gc_object
+{
+  gc_ptr<GcA> ptrA;
+  GcB() = default;
+  GcB(const GcB &) = delete;
+  GcB &operator=(const GcB &) = delete;
+  ~GcB() override
+  {
+    fmt::print("GcB destroyed\n");
+  }
+  void trace(const gc_tracer &tracer) const override
+  {
+    tracer(ptrA);
+  }
+};
+
+void test04()
+{
+  {
+    auto a = make_gc<GcA>();
+    auto b = make_gc<GcB>();
+    a->ptrB = b;  // A 持有 B
+    b->ptrA = a;  // B 持有 A
+  }
+  // 离开作用域后 A 和 B 的引用计数都是 1, 与 test01 一样不会立即释放, 但它们被记录为候选根
+  fmt::println("pending roots = {}", cycle_collector::instance().pendingRoots());
+  auto result = cycle_collector::instance().collect();
+  fmt::println("collect: roots = {}, visited = {}, freed = {}", result.roots, result.visited, result.freed);
+}
+
+/// @brief 基准测试用的图节点: 每个节点一条环边 + 一条簇内随机弦
+struct GcNode : gc_object
+{
+  static inline std::size_t live = 0;
+  gc_ptr<GcNode> next;
+  gc_ptr<GcNode> chord;
+  GcNode()
+  {
+    ++live;
+  }
+  GcNode(const GcNode &) = delete;
+  GcNode &operator=(const GcNode &) = delete;
+  ~GcNode() override
+  {
+    --live;
+  }
+  void trace(const gc_tracer &tracer) const override
+  {
+    tracer(next);
+    tracer(chord);
+  }
+};
+
+/// @brief 由大量小型环组成的图: 每个簇 kClusterSize 个节点首尾相连, 外部只持有簇的第一个节点
+/// 丢弃 3/4 的外部引用, 然后以固定的工作量预算增量回收, 统计吞吐量和每次停顿的分位数
+void benchCycleCollector()
+{
+  constexpr std::size_t kNodes = 2'000'000;
+  constexpr std::size_t kClusterSize = 8;
+  constexpr std::size_t kClusters = kNodes / kClusterSize;
+  constexpr std::size_t kBudget = 4096;  // 每次 collect 访问的节点数上限
+
+  fmt::println("cycle collector: {} nodes, {} clusters of {}, budget {} nodes/step", kNodes, kClusters,
+               kClusterSize, kBudget);
+  std::vector<gc_ptr<GcNode>> heads;
+  heads.reserve(kClusters);
+  std::uint32_t seed = 12345;
+  auto build_start = std::chrono::steady_clock::now();
+  for (std::size_t c = 0; c < kClusters; ++c)
+  {
+    std::vector<gc_ptr<GcNode>> nodes(kClusterSize);
+    for (auto &n : nodes) n = make_gc<GcNode>();
+    for (std::size_t i = 0; i < kClusterSize; ++i)
+    {
+      seed = seed * 1664525U + 1013904223U;  // LCG, 结果可复现
+      nodes[i]->next = nodes[(i + 1) % kClusterSize];
+      nodes[i]->chord = nodes[(seed >> 16) % kClusterSize];
+    }
+    heads.push_back(nodes.front());
+  }
+  auto build_stop = std::chrono::steady_clock::now();
+  // 建图过程中计数减到非 0 的节点都进了候选根缓冲区, 先回收一遍(全部存活, 不会释放任何对象)
+  cycle_collector::instance().collect();
+
+  // 丢弃 3/4 的簇
+  for (std::size_t c = 0; c < kClusters; ++c)
+    if (c % 4 != 0) heads[c].reset();
+  const std::size_t expected_live = (kClusters + 3) / 4 * kClusterSize;
+
+  std::vector<double> pauses;
+  std::size_t freed = 0;
+  auto collect_start = std::chrono::steady_clock::now();
+  while (cycle_collector::instance().pendingRoots() != 0)
+  {
+    auto start = std::chrono::steady_clock::now();
+    freed += cycle_collector::instance().collect(kBudget).freed;
+    auto stop = std::chrono::steady_clock::now();
+    pauses.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+  }
+  auto collect_stop = std::chrono::steady_clock::now();
+
+  std::sort(pauses.begin(), pauses.end());
+  auto percentile = [&](double p)
+  {
+    return pauses[static_cast<std::size_t>(p * static_cast<double>(pauses.size() - 1))];
+  };
+  const double build_ms = std::chrono::duration<double, std::milli>(build_stop - build_start).count();
+  const double collect_ms = std::chrono::duration<double, std::milli>(collect_stop - collect_start).count();
+  fmt::println("  build        {:>10.1f} ms", build_ms);
+  fmt::println("  collect      {:>10.1f} ms, {} steps, freed {} nodes ({:.1f} M nodes/s)", collect_ms, pauses.size(),
+               freed, static_cast<double>(freed) / collect_ms / 1000.0);
+  fmt::println("  pause (us)   p50 {:.1f}, p90 {:.1f}, p99 {:.1f}, max {:.1f}", percentile(0.50), percentile(0.90),
+               percentile(0.99), pauses.back());
+  fmt::println("  live nodes   {} (expected {})", GcNode::live, expected_live);
+
+  heads.clear();
+  cycle_collector::instance().collect();
+  fmt::println("  after drop   {} live nodes", GcNode::live);
+}
+
+/// @brief observer_table 与 weak_ptr 的用法对比: 所有者失效后查找得到空指针
+void test05()
+{
+  observer_table<Object> table(4);
+  table.publish(0, std::make_unique<Object>(18));
+  if (auto hp = table.lookup(0))  // 相当于 wp.lock(), 但不修改引用计数
+  {
+    fmt::println("Object is still alive id = {}", hp->id());
+  }
+  table.expire(0);  // 相当于最后一个 shared_ptr 被释放, 对象延迟到没有 hazard 保护时删除
+  fmt::println("lookup after expire: {}", table.lookup(0) ? "alive" : "expired");
+
+  // hazard_ptr 可以交给其他线程析构, 槽位会归还到领取它的线程记录上
+  table.publish(1, std::make_unique<Object>(19));
+  for (int round = 0; round < 2; ++round)
+  {
+    std::vector<hazard_ptr<Object>> held;
+    for (std::size_t i = 0; i < hazard_domain::kSlotsPerThread; ++i) held.push_back(table.lookup(1));
+    std::thread([held = std::move(held)]() mutable { held.clear(); }).join();
+  }
+  fmt::println("slots released by another thread can be reused: {}", table.lookup(1) ? "yes" : "no");
+  hazard_domain::instance().reclaim();
+}
+
+struct CacheEntry
+{
+  std::uint64_t key;
+};
+
+/// @brief threads 个线程同时执行 ops_per_thread 次查找, 返回按总查找次数平均的耗时(ns)
+template <typename Lookup>
+double concurrentLookup(unsigned threads, std::size_t ops_per_thread, std::size_t keys, Lookup lookup)
+{
+  std::atomic<bool> go{false};
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    workers.emplace_back(
+      [&, t]
+      {
+        std::uint32_t seed = 2654435761U * (t + 1);
+        std::uint64_t sum = 0;
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        for (std::size_t i = 0; i < ops_per_thread; ++i)
+        {
+          seed = seed * 1664525U + 1013904223U;
+          sum += lookup((seed >> 8) % keys);
+        }
+        bench::doNotOptimize(sum);
+      });
+  }
+  return bench::nsPerOp(threads * ops_per_thread,
+                        [&]
+                        {
+                          go.store(true, std::memory_order_release);
+                          for (auto &w : workers) w.join();
+                        });
+}
+
+/// @brief 多线程查找弱引用缓存: weak_ptr::lock() 对比 observer_table::lookup()
+void benchObserverTable()
+{
+  constexpr std::size_t kOps = 2'000'000;
+  constexpr std::size_t kCapacity = 4096;
+  const unsigned threads = std::min(8U, std::max(4U, std::thread::hardware_concurrency()));
+
+  std::vector<std::shared_ptr<CacheEntry>> owners;
+  std::vector<std::weak_ptr<CacheEntry>> weak_cache;
+  observer_table<CacheEntry> table(kCapacity);
+  for (std::size_t k = 0; k < kCapacity; ++k)
+  {
+    owners.push_back(std::make_shared<CacheEntry>(CacheEntry{k}));
+    weak_cache.emplace_back(owners.back());
+    table.publish(k, std::make_unique<CacheEntry>(CacheEntry{k}));
+  }
+  auto weak_lookup = [&](std::size_t k) -> std::uint64_t
+  {
+    auto sp = weak_cache[k].lock();
+    return sp ? sp->key : 0;
+  };
+  auto hazard_lookup = [&](std::size_t k) -> std::uint64_t
+  {
+    auto hp = table.lookup(k);
+    return hp ? hp->key : 0;
+  };
+
+  fmt::println("weak reference cache lookup, {} threads x {} ops:", threads, kOps);
+  for (std::size_t keys : {std::size_t{16}, kCapacity})
+  {
+    fmt::println(" {} keys", keys);
+    bench::report("weak_ptr::lock()", concurrentLookup(threads, kOps, keys, weak_lookup));
+    bench::report("observer_table::lookup()", concurrentLookup(threads, kOps, keys, hazard_lookup));
+  }
+
+  // 一个写线程不断替换缓存项, 读线程检查读到的对象始终完整有效
+  std::atomic<bool> stop{false};
+  std::atomic<std::size_t> errors{0};
+  std::size_t republished = 0;
+  std::thread writer(
+    [&]
+    {
+      for (std::size_t k = 0; !stop.load(std::memory_order_relaxed); k = (k + 1) % 16, ++republished)
+        table.publish(k, std::make_unique<CacheEntry>(CacheEntry{k}));
+      hazard_domain::instance().reclaim();
+    });
+  auto checked_lookup = [&](std::size_t k) -> std::uint64_t
+  {
+    auto hp = table.lookup(k);
+    if (!hp || hp->key != k) errors.fetch_add(1, std::memory_order_relaxed);
+    return hp ? hp->key : 0;
+  };
+  double ns = concurrentLookup(threads, kOps, 16, checked_lookup);
+  stop.store(true, std::memory_order_relaxed);
+  writer.join();
+  fmt::println(" 16 keys, concurrent writer ({} republished, {} errors)", republished, errors.load());
+  bench::report("observer_table::lookup()", ns);
+}
+
 int main()
 {
   test01();
@@ -138,4 +408,11 @@ int main()
   fmt::print("------------------\n");
   test03();
   fmt::print("------------------\n");
+  test04();
+  fmt::print("------------------\n");
+  test05();
+  fmt::print("------------------\n");
+  benchCycleCollector();
+  fmt::print("------------------\n");
+  benchObserverTable();
 }
\ No newline at end of file
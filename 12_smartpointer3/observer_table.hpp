@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "hazard_pointer.hpp"
+
+/**
+ * observer_table: 用风险指针代替 weak_ptr 的弱引用缓存.
+ *
+ * weak_ptr::lock() 需要在控制块上做 CAS 循环(use_count != 0 时 +1), 随后 shared_ptr 析构再做一次原子减;
+ * 多个线程频繁查找同一个缓存项时, 所有线程都在争抢同一个控制块的缓存行.
+ * observer_table 的每个槽位是一个 std::atomic<T *>, 由写线程(所有者)发布和失效:
+ *   lookup(i)  : 读取槽位 + 发布 hazard + 确认, 返回 hazard_ptr<T>, 在它析构之前对象不会被删除.
+ *   publish(i) : 放入新对象, 旧对象交给 hazard_domain 延迟删除.
+ *   expire(i)  : 清空槽位, 相当于对象的最后一个 shared_ptr 被释放, 之后的 lookup 得到空指针.
+ * 读路径不修改任何共享计数; 代价是 hazard_ptr 只能短暂持有(每个线程最多 kSlotsPerThread 个), 不能代替 shared_ptr 长期保存.
+ */
+
+/// @brief 受 hazard 保护的指针, 只能移动, 析构时解除保护
+template <typename T>
+class hazard_ptr
+{
+ public:
+  hazard_ptr() noexcept = default;
+  hazard_ptr(T *ptr, hazard_domain::slot slot) noexcept : ptr_(ptr), slot_(slot) {}
+  hazard_ptr(hazard_ptr &&other) noexcept :
+    ptr_(std::exchange(other.ptr_, nullptr)), slot_(std::exchange(other.slot_, hazard_domain::slot{}))
+  {
+  }
+  hazard_ptr &operator=(hazard_ptr &&other) noexcept
+  {
+    hazard_ptr(std::move(other)).swap(*this);
+    return *this;
+  }
+  hazard_ptr(const hazard_ptr &) = delete;
+  hazard_ptr &operator=(const hazard_ptr &) = delete;
+  ~hazard_ptr()
+  {
+    if (slot_) hazard_domain::releaseSlot(slot_);
+  }
+
+  void swap(hazard_ptr &other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+    std::swap(slot_, other.slot_);
+  }
+
+  [[nodiscard]] T *get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T &operator*() const noexcept
+  {
+    return *ptr_;
+  }
+
+  T *operator->() const noexcept
+  {
+    return ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+ private:
+  T *ptr_ = nullptr;
+  hazard_domain::slot slot_;  // 记录槽位所属的线程记录, 在其他线程析构时也能正确归还
+};
+
+template <typename T>
+class observer_table
+{
+ public:
+  explicit observer_table(std::size_t capacity) : slots_(capacity)
+  {
+    for (auto &slot : slots_) slot.store(nullptr, std::memory_order_relaxed);
+  }
+  observer_table(const observer_table &) = delete;
+  observer_table &operator=(const observer_table &) = delete;
+  ~observer_table()
+  {
+    // 销毁表时不能再有读线程, 直接释放
+    for (auto &slot : slots_) delete slot.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept
+  {
+    return slots_.size();
+  }
+
+  /// @brief 查找: 槽位为空(已失效)时返回空的 hazard_ptr
+  hazard_ptr<T> lookup(std::size_t index) const
+  {
+    const std::atomic<T *> &src = slots_[index];
+    T *ptr = src.load(std::memory_order_acquire);
+    if (ptr == nullptr) return {};
+    hazard_domain &domain = hazard_domain::instance();
+    const hazard_domain::slot hazard = domain.acquireSlot();
+    for (;;)
+    {
+      hazard.hazard().store(ptr, std::memory_order_seq_cst);
+      T *again = src.load(std::memory_order_seq_cst);
+      if (again == ptr) return hazard_ptr<T>(ptr, hazard);  // 发布 hazard 之后对象仍在槽位中, 已受保护
+      if (again == nullptr)
+      {
+        hazard_domain::releaseSlot(hazard);
+        return {};
+      }
+      ptr = again;
+    }
+  }
+
+  /// @brief 放入新对象, 原有对象延迟删除
+  void publish(std::size_t index, std::unique_ptr<T> object)
+  {
+    retire(slots_[index].exchange(object.release(), std::memory_order_seq_cst));
+  }
+
+  /// @brief 使缓存项失效
+  void expire(std::size_t index)
+  {
+    retire(slots_[index].exchange(nullptr, std::memory_order_seq_cst));
+  }
+
+ private:
+  static void retire(T *old)
+  {
+    if (old == nullptr) return;
+    hazard_domain::instance().retire(old, [](void *p) { delete static_cast<T *>(p); });
+  }
+
+  std::vector<std::atomic<T *>> slots_;
+};
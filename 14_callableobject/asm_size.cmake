@@ -0,0 +1,30 @@
+# 统计汇编文件中每个 styleNN_xxx 函数的指令条数
+# 用法: cmake -DASM_FILE=callable_styles.s -P asm_size.cmake
+
+if(NOT EXISTS "${ASM_FILE}")
+  message(FATAL_ERROR "找不到汇编文件: ${ASM_FILE}")
+endif()
+
+file(STRINGS "${ASM_FILE}" lines)
+
+set(current "")
+set(count 0)
+message(STATUS "instructions  function")
+foreach(line IN LISTS lines)
+  if(line MATCHES "^_?(style[0-9]+_[a-z_]+):")
+    set(current "${CMAKE_MATCH_1}")
+    set(count 0)
+  elseif(NOT current STREQUAL "")
+    # 函数结束标记: ELF 为 .size / .cfi_endproc, Mach-O 为 .cfi_endproc, MinGW 为 .seh_endproc
+    if(line MATCHES "^[ \t]+\\.(size|cfi_endproc|seh_endproc)")
+      string(LENGTH "${count}" width)
+      math(EXPR pad "12 - ${width}")
+      string(REPEAT " " ${pad} spaces)
+      message(STATUS "${spaces}${count}  ${current}")
+      set(current "")
+    # 以空白开头且不是 . 开头的伪指令, 就是一条真实指令
+    elseif(line MATCHES "^[ \t]+[a-zA-Z]")
+      math(EXPR count "${count} + 1")
+    endif()
+  endif()
+endforeach()
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * constexpr 版本的 bind_front / bind_back / member_fn, 用来替代 std::bind 和 std::mem_fn.
+ *
+ * std::bind 的问题:
+ *   - 返回类型是未指明的复杂类型, 参数通过占位符(_1, _2...)重新排列, 再被 std::function 包装后编译器几乎无法内联.
+ *   - 被绑定的函数指针作为运行期数据保存在对象里, 调用时是一次间接调用.
+ *   - C++17 中不是 constexpr.
+ *
+ * 这里的实现:
+ *   - bind_front(f, args...) : 把 args 绑定到参数列表前面, 等价于 C++20 的 std::bind_front.
+ *   - bind_back(f, args...)  : 把 args 绑定到参数列表后面, 等价于 C++23 的 std::bind_back.
+ *   - bind_front<&add>(3)    : 函数作为模板实参, 是编译期常量, 调用点永远是直接调用, 可以被完全内联.
+ *   - member_fn<&Math::add>  : 成员函数指针作为模板实参, 是一个空对象, 用来替代 std::mem_fn.
+ */
+
+namespace detail
+{
+template <typename T>
+struct member_class;
+
+template <typename M, typename C>
+struct member_class<M C::*>
+{
+  using type = C;
+};
+
+/// @brief 成员指针的调用: obj 可以是对象(引用), 也可以是指针或智能指针
+template <typename F, typename Obj, typename... Args>
+constexpr decltype(auto) invokeMember(F f, Obj &&obj, Args &&...args)
+{
+  using C = typename member_class<F>::type;
+  constexpr bool is_object = std::is_base_of_v<C, std::decay_t<Obj>>;
+  if constexpr (std::is_member_function_pointer_v<F>)
+  {
+    if constexpr (is_object)
+      return (std::forward<Obj>(obj).*f)(std::forward<Args>(args)...);
+    else
+      return ((*std::forward<Obj>(obj)).*f)(std::forward<Args>(args)...);
+  }
+  else
+  {
+    static_assert(sizeof...(Args) == 0, "成员变量指针不接受额外参数");
+    if constexpr (is_object)
+      return (std::forward<Obj>(obj).*f);
+    else
+      return ((*std::forward<Obj>(obj)).*f);
+  }
+}
+}  // namespace detail
+
+/// @brief C++17 的 std::invoke 不是 constexpr, 这里提供一个 constexpr 的版本
+template <typename F, typename... Args>
+constexpr decltype(auto) constexpr_invoke(F &&f, Args &&...args)
+{
+  if constexpr (std::is_member_pointer_v<std::decay_t<F>>)
+    return detail::invokeMember(f, std::forward<Args>(args)...);
+  else
+    return std::forward<F>(f)(std::forward<Args>(args)...);
+}
+
+/// @brief 绑定部分参数后的可调用对象, Front 为 true 时绑定在前, 否则绑定在后
+template <bool Front, typename F, typename... Bound>
+class binder
+{
+ public:
+  // 第一个参数用 in_place 作标记, 避免这个模板构造函数抢走拷贝构造
+  template <typename G, typename... Ts>
+  constexpr binder(std::in_place_t, G &&f, Ts &&...bound) : f_(std::forward<G>(f)), bound_(std::forward<Ts>(bound)...)
+  {
+  }
+
+  template <typename... Args>
+  constexpr decltype(auto) operator()(Args &&...args) &
+  {
+    return call(*this, std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  constexpr decltype(auto) operator()(Args &&...args) const &
+  {
+    return call(*this, std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  constexpr decltype(auto) operator()(Args &&...args) &&
+  {
+    return call(std::move(*this), std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename Self, std::size_t... I, typename... Args>
+  static constexpr decltype(auto) call(Self &&self, std::index_sequence<I...>, Args &&...args)
+  {
+    if constexpr (Front)
+      return constexpr_invoke(std::forward<Self>(self).f_, std::get<I>(std::forward<Self>(self).bound_)...,
+                              std::forward<Args>(args)...);
+    else
+      return constexpr_invoke(std::forward<Self>(self).f_, std::forward<Args>(args)...,
+                              std::get<I>(std::forward<Self>(self).bound_)...);
+  }
+
+  F f_;
+  std::tuple<Bound...> bound_;
+};
+
+/// @brief 编译期常量函数的调用包装, 本身是空对象
+template <auto Fn>
+struct constant_fn
+{
+  template <typename... Args>
+  constexpr decltype(auto) operator()(Args &&...args) const
+  {
+    return constexpr_invoke(Fn, std::forward<Args>(args)...);
+  }
+};
+
+/// @brief 把参数绑定到前面: bind_front(add, 3)(4) == add(3, 4)
+template <typename F, typename... Args>
+constexpr auto bind_front(F &&f, Args &&...args)
+{
+  using binder_type = binder<true, std::decay_t<F>, std::decay_t<Args>...>;
+  return binder_type(std::in_place, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+/// @brief 函数作为模板实参的版本: bind_front<&add>(3)(4) == add(3, 4), 对象里不保存函数指针
+template <auto Fn, typename... Args>
+constexpr auto bind_front(Args &&...args)
+{
+  using binder_type = binder<true, constant_fn<Fn>, std::decay_t<Args>...>;
+  return binder_type(std::in_place, constant_fn<Fn>{}, std::forward<Args>(args)...);
+}
+
+/// @brief 把参数绑定到后面: bind_back(sub, 3)(10) == sub(10, 3)
+template <typename F, typename... Args>
+constexpr auto bind_back(F &&f, Args &&...args)
+{
+  using binder_type = binder<false, std::decay_t<F>, std::decay_t<Args>...>;
+  return binder_type(std::in_place, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <auto Fn, typename... Args>
+constexpr auto bind_back(Args &&...args)
+{
+  using binder_type = binder<false, constant_fn<Fn>, std::decay_t<Args>...>;
+  return binder_type(std::in_place, constant_fn<Fn>{}, std::forward<Args>(args)...);
+}
+
+/// @brief std::mem_fn 的替代: member_fn<&Math::add>(math, 3, 4), 成员函数指针是编译期常量
+template <auto MemPtr>
+inline constexpr constant_fn<MemPtr> member_fn{};
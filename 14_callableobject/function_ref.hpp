@@ -0,0 +1,138 @@
+#pragma once
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * function_ref<R(Args...)>: 非拥有(non-owning)的可调用对象视图.
+ *
+ * 与 std::function 的区别:
+ *   - std::function 拥有被包装的对象, 捕获较大的 lambda 时需要堆分配, 拷贝时也要拷贝被包装对象.
+ *   - function_ref 只保存 "对象地址 + 一个跳板函数指针", 可平凡拷贝, 永不分配内存.
+ *     成员函数指针按值保存(Itanium ABI 下占两个指针), 所以 function_ref 是三个指针大小.
+ *
+ * 适用场景: 被调用方只在本次调用期间使用回调, 不会保存它(例如 for_each / visit / 排序比较器).
+ *
+ * 注意: function_ref 不延长被引用对象的生命周期, 和 string_view 一样, 不要把它保存到比实参活得更久的地方.
+ *   function_ref<int(int)> f = [](int x) { return x; };  // 错误: 临时 lambda 在这一行结束后就销毁了
+ *   apply(function_ref<int(int)>([](int x) { return x; }));  // 正确: 临时对象活到整个调用表达式结束
+ */
+template <typename Signature>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+ public:
+  /// @brief 从普通函数(函数指针)构造, 直接保存函数地址, 不存在悬垂问题
+  template <typename F, std::enable_if_t<std::is_function_v<F> && std::is_invocable_r_v<R, F *, Args...>, int> = 0>
+  function_ref(F *fn) noexcept : callback_(&callFunction<F>)  // NOLINT(google-explicit-constructor)
+  {
+    storage_.fn = reinterpret_cast<void (*)()>(fn);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  /// @brief 从仿函数, lambda 等任意可调用对象构造(通过 std::invoke 调用), 只保存其地址
+  template <typename F, typename T = std::remove_reference_t<F>,
+            std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, function_ref> && !std::is_function_v<T> &&
+                               !std::is_member_function_pointer_v<std::remove_cv_t<T>> &&
+                               std::is_invocable_r_v<R, T &, Args...>,
+                             int> = 0>
+  function_ref(F &&f) noexcept : callback_(&callObject<T>)  // NOLINT(google-explicit-constructor)
+  {
+    storage_.obj = const_cast<void *>(static_cast<const void *>(std::addressof(f)));
+  }
+
+  /// @brief 从成员函数指针构造, 第一个参数是对象(引用或指针). 成员函数指针按值保存, 临时值(&Math::add)也可以
+  template <typename M, std::enable_if_t<std::is_member_function_pointer_v<M> && std::is_invocable_r_v<R, M, Args...>,
+                                         int> = 0>
+  function_ref(M pmf) noexcept : callback_(&callMember<M>)  // NOLINT(google-explicit-constructor)
+  {
+    static_assert(sizeof(M) <= sizeof(storage_.pmf), "member function pointer does not fit");
+    std::memcpy(&storage_.pmf, &pmf, sizeof(M));
+  }
+
+  function_ref(const function_ref &) noexcept = default;
+  function_ref &operator=(const function_ref &) noexcept = default;
+  ~function_ref() = default;
+
+  R operator()(Args... args) const
+  {
+    return callback_(storage_, std::forward<Args>(args)...);
+  }
+
+ private:
+  // 函数指针, 对象指针, 成员函数指针不能互相转换, 所以用 union 分开保存.
+  // 成员函数指针的大小取决于类(MSVC 上多重 / 虚继承的类更大), 用一个只声明的类型取最大的表示
+  struct UnknownClass;
+  union Storage
+  {
+    void *obj;
+    void (*fn)();
+    void (UnknownClass::*pmf)();
+  };
+
+  template <typename F>
+  static R callFunction(Storage s, Args... args)
+  {
+    auto *fn = reinterpret_cast<F *>(s.fn);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if constexpr (std::is_void_v<R>)
+      std::invoke(fn, std::forward<Args>(args)...);
+    else
+      return std::invoke(fn, std::forward<Args>(args)...);
+  }
+
+  template <typename T>
+  static R callObject(Storage s, Args... args)
+  {
+    auto &obj = *static_cast<T *>(s.obj);
+    if constexpr (std::is_void_v<R>)
+      std::invoke(obj, std::forward<Args>(args)...);
+    else
+      return std::invoke(obj, std::forward<Args>(args)...);
+  }
+
+  template <typename M>
+  struct MemberClass;
+  template <typename C, typename M>
+  struct MemberClass<M C::*>
+  {
+    using type = C;
+  };
+
+  template <typename M>
+  static R callMember(Storage s, Args... args)
+  {
+    M pmf;
+    std::memcpy(&pmf, &s.pmf, sizeof(M));
+    return invokeMember(pmf, std::forward<Args>(args)...);
+  }
+
+  // 内联到调用方后 GCC 知道对象的大小(例如空类只有 1 字节), 会对成员函数指针调用中 "虚函数" 分支读取虚表指针的代码
+  // 误报 -Warray-bounds; 这个分支只在成员函数指针指向虚函数时执行, 此时对象一定有虚表指针
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+  template <typename M, typename Obj, typename... Rest>
+  static R invokeMember(M pmf, Obj &&obj, Rest &&...rest)
+  {
+    using Class = typename MemberClass<M>::type;
+    if constexpr (std::is_base_of_v<Class, std::decay_t<Obj>>)
+      return (std::forward<Obj>(obj).*pmf)(std::forward<Rest>(rest)...);
+    else if constexpr (std::is_pointer_v<std::decay_t<Obj>>)
+      return (obj->*pmf)(std::forward<Rest>(rest)...);
+    else  // std::reference_wrapper, 智能指针等交给 std::invoke
+      return std::invoke(pmf, std::forward<Obj>(obj), std::forward<Rest>(rest)...);
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+  Storage storage_{};
+  R (*callback_)(Storage, Args...) = nullptr;
+};
+
+static_assert(std::is_trivially_copyable_v<function_ref<int(int, int)>>, "function_ref 必须可平凡拷贝");
+static_assert(sizeof(function_ref<int(int, int)>) <= 3 * sizeof(void *), "function_ref 最多三个指针大小");
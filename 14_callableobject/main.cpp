@@ -2,6 +2,10 @@
 #include <future>
 #include <functional>
 
+#include "bench.hpp"
+#include "bind.hpp"
+#include "function_ref.hpp"
+
 /**
  * 在 C++ 中，可调用对象是指那些可以通过 `operator()` 被调用的对象。C++ 提供了多种方式来创建和使用可调用对象.
  */
@@ -29,6 +33,166 @@ public:
   }
 };
 
+/************************** 回调传参方式的性能对比 **************************/
+// 被调用方都不保存回调, 只在本次调用期间使用, 这是 function_ref 的典型场景
+// 回调内容很轻(一次加法), 测到的主要是调用开销, 以及能否被内联
+
+template <typename F>
+BENCH_NOINLINE unsigned accumulateTemplate(F &&f, int n)  // 模板参数: 编译器能看到具体类型, 可以完全内联
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(i & 0xFF, 1));
+  return acc;
+}
+
+BENCH_NOINLINE unsigned accumulateFunctionRef(function_ref<int(int, int)> f, int n)
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(i & 0xFF, 1));
+  return acc;
+}
+
+BENCH_NOINLINE unsigned accumulateStdFunction(const std::function<int(int, int)> &f, int n)
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(i & 0xFF, 1));
+  return acc;
+}
+
+BENCH_NOINLINE unsigned accumulatePointer(int (*f)(int, int), int n)
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(i & 0xFF, 1));
+  return acc;
+}
+
+// 每次调用都要把回调包装一次: std::function 捕获较大的 lambda 时会堆分配
+BENCH_NOINLINE int callOnceFunctionRef(function_ref<int(int, int)> f, int x)
+{
+  return f(x, 1);
+}
+
+BENCH_NOINLINE int callOnceStdFunction(const std::function<int(int, int)> &f, int x)
+{
+  return f(x, 1);
+}
+
+void benchmark()
+{
+  constexpr int kIterations = 10'000'000;
+  fmt::println("========== benchmark: {} calls ==========", kIterations);
+
+  auto lambda = [](int a, int b)
+  {
+    return a + b;
+  };
+  auto bound = std::bind(add, std::placeholders::_1, std::placeholders::_2);
+  std::function<int(int, int)> func = add;
+  std::function<int(int, int)> bound_func = bound;
+
+  // 统一的计时入口: run 内部完成 kIterations 次调用
+  auto measure = [&](const char *name, auto run)
+  {
+    bench::report(name, bench::nsPerOp(kIterations, [&]
+                                       { bench::doNotOptimize(run()); }));
+  };
+
+  fmt::println("-- 循环调用同一个回调:");
+  measure("template + lambda (inlined)", [&]
+          { return accumulateTemplate(lambda, kIterations); });
+  measure("template + std::bind", [&]
+          { return accumulateTemplate(bound, kIterations); });
+  measure("raw function pointer", [&]
+          { return accumulatePointer(&add, kIterations); });
+  measure("function_ref(lambda)", [&]
+          { return accumulateFunctionRef(lambda, kIterations); });
+  measure("function_ref(std::bind)", [&]
+          { return accumulateFunctionRef(bound, kIterations); });
+  measure("std::function(function)", [&]
+          { return accumulateStdFunction(func, kIterations); });
+  measure("std::function(std::bind)", [&]
+          { return accumulateStdFunction(bound_func, kIterations); });
+
+  fmt::println("-- 每次调用都重新包装一个捕获了 32 字节的 lambda:");
+  long long a = 1, b = 2, c = 3, d = 4;
+  auto capturing = [a, b, c, d](int x, int y)
+  {
+    return static_cast<int>(x + y + a + b + c + d);
+  };
+  measure("function_ref (no allocation)", [&]
+          {
+            unsigned acc = 0;
+            for (int i = 0; i < kIterations; ++i) acc += static_cast<unsigned>(callOnceFunctionRef(capturing, i & 0xFF));
+            return acc;
+          });
+  measure("std::function (heap allocation)", [&]
+          {
+            unsigned acc = 0;
+            for (int i = 0; i < kIterations; ++i) acc += static_cast<unsigned>(callOnceStdFunction(capturing, i & 0xFF));
+            return acc;
+          });
+}
+
+/********************* std::bind / std::mem_fn 与 bind_front / member_fn 对比 *********************/
+
+// 可调用对象按值传入, 编译器看不到其中保存的函数指针是什么, 只有类型里编码了函数的版本才能内联
+template <typename F>
+BENCH_NOINLINE unsigned accumulateUnary(F f, int n)
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(i & 0xFF));
+  return acc;
+}
+
+template <typename F>
+BENCH_NOINLINE unsigned accumulateMember(F f, Math &math, int n)
+{
+  unsigned acc = 0;
+  for (int i = 0; i < n; ++i) acc += static_cast<unsigned>(f(math, i & 0xFF, 1));
+  return acc;
+}
+
+void benchmarkBind()
+{
+  constexpr int kIterations = 10'000'000;
+  fmt::println("========== benchmark: bind / mem_fn, {} calls ==========", kIterations);
+  Math math;
+  auto measure = [&](const char *name, auto run)
+  {
+    bench::report(name, bench::nsPerOp(kIterations, [&]
+                                       { bench::doNotOptimize(run()); }));
+  };
+
+  measure("std::bind(add, 3, _1)", [&]
+          { return accumulateUnary(std::bind(add, 3, std::placeholders::_1), kIterations); });
+  measure("bind_front(add, 3)", [&]
+          { return accumulateUnary(bind_front(add, 3), kIterations); });
+  measure("bind_front<&add>(3)", [&]
+          { return accumulateUnary(bind_front<&add>(3), kIterations); });
+  measure("std::function(std::bind)", [&]
+          {
+            std::function<int(int)> fn = std::bind(add, 3, std::placeholders::_1);
+            return accumulateUnary(std::cref(fn), kIterations);
+          });
+  measure("std::function(bind_front<&add>)", [&]
+          {
+            std::function<int(int)> fn = bind_front<&add>(3);
+            return accumulateUnary(std::cref(fn), kIterations);
+          });
+  measure("std::mem_fn(&Math::add)", [&]
+          { return accumulateMember(std::mem_fn(&Math::add), math, kIterations); });
+  measure("member_fn<&Math::add>", [&]
+          { return accumulateMember(member_fn<&Math::add>, math, kIterations); });
+
+  fmt::println("-- 对象大小(字节):");
+  fmt::println("  std::bind(add, 3, _1)   : {}", sizeof(std::bind(add, 3, std::placeholders::_1)));
+  fmt::println("  bind_front(add, 3)      : {}", sizeof(bind_front(add, 3)));
+  fmt::println("  bind_front<&add>(3)     : {}", sizeof(bind_front<&add>(3)));
+  fmt::println("  std::mem_fn(&Math::add) : {}", sizeof(std::mem_fn(&Math::add)));
+  fmt::println("  member_fn<&Math::add>   : {}", sizeof(member_fn<&Math::add>));
+  fmt::println("-- 各写法的指令条数: cmake --build <build> --target callableobject_asm");
+}
+
 int main()
 {
   fmt::println("========== callable object ==========");
@@ -78,5 +242,30 @@ int main()
   std::function<int(Math &, int, int)> add_mem_fn = std::mem_fn(&Math::add);
   fmt::println("10. std::mem_fn: {}", add_mem_fn(math, 3, 4)); // 需要传入一个类对象
 
+  // 11. function_ref 非拥有的可调用对象视图, 可以引用以上任意一种可调用对象, 不分配内存
+  function_ref<int(int, int)> ref = add;
+  fmt::println("11. function_ref(Function): {}", ref(3, 4));
+  ref = adder;
+  fmt::println("11. function_ref(Functor): {}", ref(3, 4));
+  ref = funcAdd;
+  fmt::println("11. function_ref(Lambda): {}", ref(3, 4));
+  function_ref<int(Math &, int, int)> mem_ref = func_ptr;  // 第一个参数是对象, 调用 (math.*func_ptr)(3, 4)
+  fmt::println("11. function_ref(Member Function Pointer): {}", mem_ref(math, 3, 4));
+
+  // 12. bind_front / bind_back / member_fn: constexpr 的 std::bind / std::mem_fn 替代品, 没有占位符, 可以完全内联
+  auto add3 = bind_front(add, 3);
+  fmt::println("12. bind_front: {}", add3(4));
+  auto add3_const = bind_front<&add>(3);  // 函数是编译期常量, 对象本身只保存绑定的参数
+  fmt::println("12. bind_front<&add>: {}", add3_const(4));
+  fmt::println("12. bind_back: {}", bind_back(&Math::add, 4)(math, 3));
+  fmt::println("12. member_fn: {}", member_fn<&Math::add>(math, 3, 4));
+  constexpr auto sub = [](int a, int b)
+  {
+    return a - b;
+  };
+  static_assert(bind_front(sub, 10)(3) == 7 && bind_back(sub, 10)(3) == -7, "编译期求值");
+
+  benchmark();
+  benchmarkBind();
   return 0;
 }
\ No newline at end of file
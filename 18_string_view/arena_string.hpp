@@ -0,0 +1,166 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * 解析记录用的字符串类型: 更大的内联缓冲区 + 内存池(arena)存放溢出部分.
+ *
+ * std::string(sv) 只能在 15 / 22 字节(libstdc++ / libc++)以内避免堆分配, 日志里的时间戳, 路径, 消息字段往往更长,
+ * 每个字段一次 malloc. arena_string 的做法:
+ *   - 不超过 InlineCapacity 个字符时直接存放在对象内部, 默认 43 个字符, 对象大小 48 字节;
+ *   - 更长的内容复制到 string_arena 中, 对象内只保存指针. string_arena 按块(默认 64KB)申请内存, 分摊到每个字段几乎为 0;
+ *   - 内容不可修改, 拷贝 arena_string 只是拷贝 48 个字节(可平凡复制), 不会再次分配.
+ * 溢出部分的生命周期由 string_arena 管理: arena 销毁或 reset() 之后, 其中的 arena_string 全部失效.
+ */
+
+/// @brief 只能追加的字符内存池, 内存在 reset() 或析构时统一释放
+class string_arena
+{
+ public:
+  explicit string_arena(std::size_t block_size = 64 * 1024) : block_size_(block_size) {}
+
+  string_arena(const string_arena &) = delete;
+  string_arena &operator=(const string_arena &) = delete;
+
+  /// @brief 复制 sv 并在末尾加上 '\0', 返回副本的首地址
+  const char *copy(std::string_view sv)
+  {
+    char *dst = allocate(sv.size() + 1);
+    std::memcpy(dst, sv.data(), sv.size());
+    dst[sv.size()] = '\0';
+    return dst;
+  }
+
+  char *allocate(std::size_t n)
+  {
+    if (n > remaining_)
+    {
+      // 大于块大小 1/4 的请求单独分配一块, 避免浪费当前块的剩余空间
+      if (n > block_size_ / 4)
+      {
+        std::unique_ptr<char[]> block(new char[n]);
+        char *p = block.get();
+        blocks_.insert(blocks_.end() - (cursor_ != nullptr ? 1 : 0), std::move(block));  // 当前块保持在最后
+        used_ += n;
+        return p;
+      }
+      blocks_.emplace_back(new char[block_size_]);
+      cursor_ = blocks_.back().get();
+      remaining_ = block_size_;
+    }
+    char *p = cursor_;
+    cursor_ += n;
+    remaining_ -= n;
+    used_ += n;
+    return p;
+  }
+
+  /// @brief 释放全部内存
+  void reset() noexcept
+  {
+    blocks_.clear();
+    cursor_ = nullptr;
+    remaining_ = 0;
+    used_ = 0;
+  }
+
+  [[nodiscard]] std::size_t bytes_used() const noexcept
+  {
+    return used_;
+  }
+  [[nodiscard]] std::size_t block_count() const noexcept
+  {
+    return blocks_.size();
+  }
+
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *cursor_ = nullptr;
+  std::size_t remaining_ = 0;
+  std::size_t used_ = 0;
+  std::size_t block_size_;
+};
+
+/// @brief 内联容量为 InlineCapacity 的只读字符串, 超出部分放在 string_arena 中
+template <std::size_t InlineCapacity = 43>
+class basic_arena_string
+{
+  static_assert(InlineCapacity >= sizeof(const char *), "inline buffer must be able to hold a pointer");
+
+ public:
+  static constexpr std::size_t inline_capacity = InlineCapacity;
+
+  basic_arena_string() noexcept : buf_{}, size_(0) {}
+
+  /// @brief 从 string_view 构造: 短字符串复制到对象内部, 长字符串复制到 arena 中
+  basic_arena_string(std::string_view sv, string_arena &arena) : size_(static_cast<std::uint32_t>(sv.size()))
+  {
+    if (sv.size() <= InlineCapacity)
+    {
+      std::memcpy(buf_, sv.data(), sv.size());
+      buf_[sv.size()] = '\0';
+    }
+    else
+    {
+      const char *p = arena.copy(sv);
+      std::memcpy(buf_, &p, sizeof(p));
+    }
+  }
+
+  [[nodiscard]] bool is_inline() const noexcept
+  {
+    return size_ <= InlineCapacity;
+  }
+  [[nodiscard]] const char *data() const noexcept
+  {
+    if (is_inline()) return buf_;
+    const char *p = nullptr;
+    std::memcpy(&p, buf_, sizeof(p));
+    return p;
+  }
+  [[nodiscard]] const char *c_str() const noexcept
+  {
+    return data();
+  }
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return size_;
+  }
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+  [[nodiscard]] std::string_view view() const noexcept
+  {
+    return {data(), size_};
+  }
+  operator std::string_view() const noexcept  // NOLINT(google-explicit-constructor)
+  {
+    return view();
+  }
+
+  friend bool operator==(const basic_arena_string &a, const basic_arena_string &b) noexcept
+  {
+    return a.view() == b.view();
+  }
+  friend bool operator!=(const basic_arena_string &a, const basic_arena_string &b) noexcept
+  {
+    return a.view() != b.view();
+  }
+  friend bool operator<(const basic_arena_string &a, const basic_arena_string &b) noexcept
+  {
+    return a.view() < b.view();
+  }
+
+ private:
+  // 内联时存放字符(多一个字节存放 '\0'), 溢出时前 8 个字节存放 arena 中的地址.
+  // 不用 union 是为了让 size_ 紧跟在 44 字节的缓冲区后面, 整个对象正好 48 字节
+  alignas(const char *) char buf_[InlineCapacity + 1];
+  std::uint32_t size_;
+};
+
+using arena_string = basic_arena_string<>;
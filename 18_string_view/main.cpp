@@ -1,10 +1,25 @@
+// 替换全局 operator new/delete 统计堆分配次数, 用来计算 "每百万个字段的分配次数"
+// 整个程序只能有一个文件定义这个宏, 而且要写在所有 #include 之前, 保证第一次包含 bench.hpp 时已经定义
+#define BENCH_COUNT_ALLOCATIONS
+
 #include <array>
 #include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <random>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "arena_string.hpp"
+#include "bench.hpp"
 #include "fmt/core.h"
+#include "parse_number.hpp"
+#include "simd_trim.hpp"
+#include "tokenizer.hpp"
 
 /**
  * @brief std::string_view（C++17）的简要说明
@@ -185,6 +200,416 @@ void test_trim()
   fmt::print("trim3      : '{}'\n", trim(s3));  // 返回空视图
 }
 
+/// @brief 生成测试字符串: 前后各有 [0, max_ws] 个随机空白字符, 中间是 body_len 个非空白字符
+std::vector<std::string> make_padded_strings(std::size_t count, std::size_t max_ws, std::size_t body_len)
+{
+  const std::string_view ws = " \t\n\r\f\v";
+  std::mt19937 rng(7);
+  std::vector<std::string> out;
+  out.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string s;
+    auto pad = [&]
+    {
+      const std::size_t n = rng() % (max_ws + 1);
+      for (std::size_t k = 0; k < n; ++k) s += ws[rng() % ws.size()];
+    };
+    pad();
+    for (std::size_t k = 0; k < body_len; ++k) s += static_cast<char>('a' + rng() % 26);
+    pad();
+    out.push_back(std::move(s));
+  }
+  return out;
+}
+
+/// @brief 检查 SIMD 实现与 trim 的结果一致
+void test_simd_trim()
+{
+  fmt::print("simd::trim kernel: {}\n", simd::trim_kernel_name());
+  fmt::print("simd::trim: '{}'\n", simd::trim("\t\n   trimmed string \r\n  "));
+
+  std::vector<const simd::detail::TrimKernels *> kernels = {&simd::detail::kScalarKernels};
+#if SIMD_X86
+  kernels.push_back(&simd::detail::kSse2Kernels);
+  if (simd::cpu().avx2) kernels.push_back(&simd::detail::kAvx2Kernels);
+#endif
+  std::size_t mismatches = 0;
+  for (std::size_t body : {0, 1, 15, 16, 17, 31, 33, 100})
+  {
+    for (const std::string &s : make_padded_strings(200, 70, body))
+    {
+      for (const auto *k : kernels) mismatches += simd::trim_with(*k, s) != trim(s) ? 1 : 0;
+      mismatches += simd::trim(s) != trim(s) ? 1 : 0;
+    }
+  }
+  fmt::print("simd::trim mismatches: {}\n", mismatches);
+}
+
+void bench_trim()
+{
+  fmt::print("========== benchmark: trim ==========\n");
+  struct Case
+  {
+    const char *title;
+    std::vector<std::string> strings;
+  };
+  Case cases[] = {
+    {"short strings (0~8 ws each side, 16 chars)", make_padded_strings(1024, 8, 16)},
+    {"long strings (0~512 ws each side, 1024 chars)", make_padded_strings(1024, 512, 1024)},
+  };
+  constexpr int kRounds = 200;
+  for (const Case &c : cases)
+  {
+    std::vector<std::string_view> views(c.strings.begin(), c.strings.end());
+    fmt::print("-- {}:\n", c.title);
+    auto run = [&](const char *name, auto &&fn)
+    {
+      bench::report(name, bench::nsPerOp(kRounds * views.size(), [&]
+                                         {
+                                           for (int r = 0; r < kRounds; ++r)
+                                             for (std::string_view sv : views) bench::doNotOptimize(fn(sv));
+                                         }));
+    };
+    run("trim (std::isspace)", [](std::string_view sv) { return trim(sv); });
+    run("trim2 (find_first_not_of)", [](std::string_view sv) { return trim2(sv); });
+    run("simd scalar", [](std::string_view sv) { return simd::trim_with(simd::detail::kScalarKernels, sv); });
+#if SIMD_X86
+    run("simd sse2", [](std::string_view sv) { return simd::trim_with(simd::detail::kSse2Kernels, sv); });
+    if (simd::cpu().avx2)
+      run("simd avx2", [](std::string_view sv) { return simd::trim_with(simd::detail::kAvx2Kernels, sv); });
+#endif
+    run("simd::trim (dispatch)", [](std::string_view sv) { return simd::trim(sv); });
+  }
+}
+
+void test_tokenizer()
+{
+  fmt::print("split_view:");
+  for (std::string_view field : tokenizer::split_view("a,,b,c,", ',')) fmt::print(" '{}'", field);
+  fmt::print("\nlines_view:");
+  for (std::string_view line : tokenizer::lines_view("first\r\nsecond\n\nfourth\n")) fmt::print(" '{}'", line);
+  fmt::print("\ncsv_view:\n");
+  const std::string_view csv = "id,name,comment\n1,\"Smith, John\",\"says \"\"hi\"\"\"\n2,\"multi\nline\",\n";
+  for (const tokenizer::csv_field &f : tokenizer::csv_view(csv))
+  {
+    fmt::print("  '{}'{}{}", f.escaped ? tokenizer::unescape(f) : std::string(f.value), f.quoted ? " (quoted)" : "",
+               f.end_of_record ? " <end of record>\n" : "\n");
+  }
+}
+
+/// @brief 逐块读取文件, 每次把完整的若干行交给 fn, 不完整的最后一行留到下一块
+template <typename Fn>
+void for_each_chunk(const char *path, std::size_t chunk_size, Fn &&fn)
+{
+  std::FILE *fp = std::fopen(path, "rb");
+  if (fp == nullptr) return;
+  std::vector<char> buffer(chunk_size);
+  std::size_t carry = 0;
+  for (;;)
+  {
+    if (carry == buffer.size()) buffer.resize(buffer.size() * 2);  // 一行比整块还长
+    const std::size_t n = std::fread(buffer.data() + carry, 1, buffer.size() - carry, fp);
+    const std::size_t filled = carry + n;
+    if (n == 0)
+    {
+      if (filled > 0) fn(std::string_view(buffer.data(), filled));
+      break;
+    }
+    std::size_t end = filled;
+    while (end > 0 && buffer[end - 1] != '\n') --end;
+    if (end == 0)
+    {
+      carry = filled;
+      continue;
+    }
+    fn(std::string_view(buffer.data(), end));
+    carry = filled - end;
+    std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(end), buffer.begin() + static_cast<std::ptrdiff_t>(filled),
+              buffer.begin());
+  }
+  std::fclose(fp);
+}
+
+/// @brief 追加 count 行 CSV 格式的日志: 时间戳, 级别, 线程, 消息(带引号, ERROR 的消息较长), 耗时, 路径
+void append_log_lines(std::string &out, std::mt19937 &rng, std::size_t count)
+{
+  const char *levels[] = {"INFO", "WARN", "ERROR", "DEBUG"};
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const unsigned id = rng();
+    out += fmt::format("2024-05-{:02}T{:02}:{:02}:{:02}.{:03}Z,{},worker-{},", id % 28 + 1, id % 24, id % 60,
+                       id / 60 % 60, id % 1000, levels[id % 4], id % 64);
+    if (id % 4 == 2)
+      out += fmt::format("\"req {} from host-{} failed: upstream connect timeout after 3 retries\",", id, id % 1000);
+    else
+      out += fmt::format("\"req {} from host-{}\",", id, id % 1000);
+    out += fmt::format("{},/api/v1/items/{}\n", id % 100000, id % 4096);
+  }
+}
+
+/// @brief 日志文件分词: std::getline + std::string 切分 vs 零拷贝分词器
+/// 文件大小默认 256MB, 可以通过环境变量 TOKENIZER_BENCH_MB 修改(例如 4096 生成 4GB 的文件)
+void bench_tokenizer()
+{
+  std::size_t megabytes = 256;
+  if (const char *env = std::getenv("TOKENIZER_BENCH_MB")) megabytes = std::strtoull(env, nullptr, 10);
+  const std::size_t file_size = megabytes << 20;
+  const char *path = "tokenizer_bench.log";
+  {
+    std::FILE *fp = std::fopen(path, "wb");
+    if (fp == nullptr)
+    {
+      fmt::print("fopen failed\n");
+      return;
+    }
+    std::mt19937 rng(3);
+    std::string block;
+    for (std::size_t written = 0; written < file_size; written += block.size())
+    {
+      block.clear();
+      append_log_lines(block, rng, 1024);
+      std::fwrite(block.data(), 1, block.size(), fp);
+    }
+    std::fclose(fp);
+  }
+
+  fmt::print("========== benchmark: tokenize {} MB log file ==========\n", megabytes);
+  auto report = [&](const char *name, double secs, std::size_t lines, std::size_t fields)
+  {
+    const double mb_per_sec = static_cast<double>(file_size) / secs / 1e6;
+    fmt::print("  {:<36} {:>8.1f} MB/s  lines {:>10}  fields {:>11}\n", name, mb_per_sec, lines, fields);
+  };
+  auto seconds = [](auto start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    std::vector<std::string> fields;
+    std::size_t lines = 0, count = 0;
+    while (std::getline(in, line))
+    {
+      fields.clear();
+      std::size_t begin = 0;
+      for (;;)
+      {
+        const std::size_t pos = line.find(',', begin);
+        fields.push_back(line.substr(begin, pos - begin));
+        if (pos == std::string::npos) break;
+        begin = pos + 1;
+      }
+      ++lines;
+      count += fields.size();
+    }
+    report("std::getline + std::string split", seconds(start), lines, count);
+  }
+  constexpr std::size_t kChunk = 16 << 20;
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t lines = 0, count = 0;
+    for_each_chunk(path, kChunk, [&](std::string_view chunk)
+                   {
+                     for (std::string_view line : tokenizer::lines_view(chunk))
+                     {
+                       ++lines;
+                       for (std::string_view field : tokenizer::split_view(line, ','))
+                       {
+                         bench::doNotOptimize(field);
+                         ++count;
+                       }
+                     }
+                   });
+    report("lines_view + split_view", seconds(start), lines, count);
+  }
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t lines = 0, count = 0;
+    for_each_chunk(path, kChunk, [&](std::string_view chunk)
+                   {
+                     for (const tokenizer::csv_field &field : tokenizer::csv_view(chunk))
+                     {
+                       bench::doNotOptimize(field.value);
+                       ++count;
+                       lines += field.end_of_record ? 1 : 0;
+                     }
+                   });
+    report("csv_view (quote aware)", seconds(start), lines, count);
+  }
+  std::remove(path);
+}
+
+/// @brief demo_string_string_view 中 string_view → string 的转换, 换成 arena_string
+void test_arena_string()
+{
+  fmt::print("=== string_view → arena_string ===\n");
+  fmt::print("sizeof(std::string) = {}, sizeof(arena_string) = {}, inline capacity = {}\n", sizeof(std::string),
+             sizeof(arena_string), arena_string::inline_capacity);
+  string_arena arena;
+  const std::size_t before = bench::allocationCount();
+
+  std::string_view sv1 = "hello world";
+  arena_string s2(sv1, arena);
+  std::string_view sv3 = "123456789";
+  arena_string s3(sv3.substr(2, 4), arena);  // "3456"
+  arena_string timestamp("2024-05-01T12:00:00.000Z", arena);
+  arena_string message("req 42 from host-7 failed: upstream connect timeout after 3 retries", arena);
+  const std::size_t after = bench::allocationCount();
+
+  for (const arena_string *s : {&s2, &s3, &timestamp, &message})
+    fmt::print("'{}' ({} chars, {})\n", s->view(), s->size(), s->is_inline() ? "inline" : "arena");
+  fmt::print("heap allocations: {} (arena blocks: {})\n", after - before, arena.block_count());
+}
+
+/// @brief 把日志的每个字段保存下来: std::string vs arena_string, 统计每百万个字段的堆分配次数
+void bench_record_strings()
+{
+  constexpr std::size_t kLines = 500'000;
+  std::mt19937 rng(5);
+  std::string text;
+  append_log_lines(text, rng, kLines);
+  const tokenizer::csv_view view(text);
+  const auto field_count = static_cast<std::size_t>(std::distance(view.begin(), view.end()));
+
+  fmt::print("========== benchmark: store {} parsed fields ==========\n", field_count);
+  auto run = [&](const char *name, auto &&store)
+  {
+    const std::size_t before = bench::allocationCount();
+    const double ns = bench::nsPerOp(field_count, [&] { store(); });
+    const double allocs = static_cast<double>(bench::allocationCount() - before);
+    fmt::print("  {:<32} {:>8.3f} ns/field  {:>10.0f} allocs per 1M fields\n", name, ns,
+               allocs * 1e6 / static_cast<double>(field_count));
+  };
+  {
+    std::vector<std::string> fields;
+    fields.reserve(field_count);  // 只统计字符串本身的分配
+    run("std::string(sv)",
+        [&]
+        {
+          for (const tokenizer::csv_field &f : view) fields.emplace_back(f.value);
+        });
+    bench::doNotOptimize(fields.back());
+  }
+  {
+    std::vector<arena_string> fields;
+    fields.reserve(field_count);
+    string_arena arena;
+    run("arena_string(sv, arena)",
+        [&]
+        {
+          for (const tokenizer::csv_field &f : view) fields.emplace_back(f.value, arena);
+        });
+    bench::doNotOptimize(fields.back());
+    std::size_t overflow = 0;
+    for (const arena_string &s : fields) overflow += s.is_inline() ? 0 : 1;
+    fmt::print("  arena_string: {} fields stored in arena, {} KB in {} blocks\n", overflow, arena.bytes_used() / 1024,
+               arena.block_count());
+  }
+}
+
+void test_parse_number()
+{
+  for (std::string_view sv : {"42", "-2147483648", "2147483648", "12a", "", "+1", " 7", "0000000000000000000000123"})
+  {
+    const auto r = parse<int>(sv);
+    fmt::print("parse<int>(\"{}\") -> {}\n", sv, r ? std::to_string(r.value) : to_string(r.error));
+  }
+  for (std::string_view sv : {"3.14159", "-0.5", ".25", "1e-3", "1e400", "0x10", "1.5.2", "12345678901234567890.5"})
+  {
+    const auto r = parse<double>(sv);
+    fmt::print("parse<double>(\"{}\") -> {}\n", sv, r ? fmt::format("{}", r.value) : to_string(r.error));
+  }
+  fmt::print("parse<std::uint8_t>(\"255\") -> {}, parse<std::uint8_t>(\"256\") -> {}\n",
+             parse<std::uint8_t>("255").value, to_string(parse<std::uint8_t>("256").error));
+
+  // 与 std::from_chars / strtod 的结果对比
+  std::mt19937_64 rng(9);
+  std::size_t mismatches = 0;
+  for (int i = 0; i < 200000; ++i)
+  {
+    const auto x = static_cast<std::int64_t>(rng()) >> (rng() % 64);
+    const std::string s = std::to_string(x);
+    mismatches += parse<std::int64_t>(s).value != x ? 1 : 0;
+    int expected = 0;
+    const bool ok = std::from_chars(s.data(), s.data() + s.size(), expected).ec == std::errc();
+    const auto narrow = parse<int>(s);
+    mismatches += ok != static_cast<bool>(narrow) || (ok && narrow.value != expected) ? 1 : 0;
+
+    const std::string d = fmt::format("{:.{}f}", static_cast<double>(x) / 997.0, rng() % 12);
+    mismatches += parse<double>(d).value != std::strtod(d.c_str(), nullptr) ? 1 : 0;
+    mismatches += parse<float>(d).value != std::strtof(d.c_str(), nullptr) ? 1 : 0;
+  }
+  fmt::print("parse mismatches: {}\n", mismatches);
+}
+
+void bench_parse_number()
+{
+  constexpr std::size_t kCount = 1'000'000;
+  std::mt19937 rng(13);
+  std::vector<std::string> ints;
+  std::vector<std::string> doubles;
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    const auto x = static_cast<std::int32_t>(rng()) >> (rng() % 31);
+    ints.push_back(std::to_string(x));
+    doubles.push_back(fmt::format("{:.{}f}", static_cast<double>(x) / 1000.0, rng() % 7));
+  }
+  // 字段通常来自分词器, 是没有 '\0' 结尾的 string_view; std::stoi / strtod 需要 std::string 或 C 字符串
+  std::vector<std::string_view> int_views(ints.begin(), ints.end());
+  std::vector<std::string_view> double_views(doubles.begin(), doubles.end());
+
+  auto run = [](const char *name, const auto &views, auto &&fn)
+  {
+    bench::report(name, bench::nsPerOp(views.size(), [&]
+                                       {
+                                         for (const auto &v : views) bench::doNotOptimize(fn(v));
+                                       }));
+  };
+  fmt::print("========== benchmark: parse {} ints ==========\n", kCount);
+  run("std::stoi(std::string(sv))", int_views, [](std::string_view sv) { return std::stoi(std::string(sv)); });
+  run("std::strtol (null-terminated)", ints, [](const std::string &s) { return std::strtol(s.c_str(), nullptr, 10); });
+  run("std::istringstream", int_views,
+      [](std::string_view sv)
+      {
+        std::istringstream in{std::string(sv)};
+        int x = 0;
+        in >> x;
+        return x;
+      });
+  run("std::from_chars", int_views,
+      [](std::string_view sv)
+      {
+        int x = 0;
+        std::from_chars(sv.data(), sv.data() + sv.size(), x);
+        return x;
+      });
+  run("parse<int>", int_views, [](std::string_view sv) { return parse<int>(sv).value; });
+
+  fmt::print("========== benchmark: parse {} doubles ==========\n", kCount);
+  run("std::stod(std::string(sv))", double_views, [](std::string_view sv) { return std::stod(std::string(sv)); });
+  run("std::strtod (null-terminated)", doubles, [](const std::string &s) { return std::strtod(s.c_str(), nullptr); });
+  run("std::istringstream", double_views,
+      [](std::string_view sv)
+      {
+        std::istringstream in{std::string(sv)};
+        double x = 0;
+        in >> x;
+        return x;
+      });
+#if PARSE_HAS_FLOAT_FROM_CHARS
+  run("std::from_chars", double_views,
+      [](std::string_view sv)
+      {
+        double x = 0;
+        std::from_chars(sv.data(), sv.data() + sv.size(), x);
+        return x;
+      });
+#endif
+  run("parse<double>", double_views, [](std::string_view sv) { return parse<double>(sv).value; });
+}
+
 void test_perf(std::string s) {}  // performance-unnecessary-value-param
 
 void test_bug()
@@ -204,5 +629,13 @@ int main()
   examples();
   demo_string_string_view();
   test_trim();
+  test_simd_trim();
+  bench_trim();
+  test_tokenizer();
+  bench_tokenizer();
+  test_arena_string();
+  bench_record_strings();
+  test_parse_number();
+  bench_parse_number();
   return 0;
 }
@@ -0,0 +1,312 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/**
+ * 从 string_view 解析数字: parse<T>(sv), T 为整数或 float / double.
+ *
+ * 规则是严格的: 整个 string_view 必须恰好是一个数字, 不允许前后空白, 不允许前导 '+', 不接受十六进制;
+ * 出错时通过 parse_result::error 说明原因, 不抛异常, 也不依赖 errno.
+ *
+ * 快速路径: 每次读取 8 个字节, 用 SWAR(寄存器内的 SIMD, 一个 64 位整数当作 8 个字节通道)判断是否全是数字,
+ * 再用 3 次乘法把 8 个数字转换成整数. 这样不依赖 SSE / NEON, 在 x86-64 和 ARM64 上都能使用.
+ *   - 整数: 不超过 19 位数字时走快速路径, 之后检查 T 的范围; 更长的(例如很多前导 0)交给 std::from_chars;
+ *   - 浮点数: 没有指数部分, 有效数字不超过 2^53(float 为 2^24), 小数位数不超过 22(float 为 10)时,
+ *     尾数和 10 的幂都能精确表示, 一次除法的结果就是正确舍入的(Clinger 快速路径), 其余情况交给 std::from_chars.
+ * 标准库没有浮点数 std::from_chars 时(GCC 11 之前的 libstdc++, 以及 macOS 上的 libc++), 慢速路径退回 strtod / strtof,
+ * 此时先检查输入格式, 保持与 from_chars 相同的严格规则.
+ */
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define PARSE_HAS_FLOAT_FROM_CHARS 1
+#else
+#define PARSE_HAS_FLOAT_FROM_CHARS 0
+#endif
+
+/// @brief 解析失败的原因
+enum class parse_error
+{
+  none,
+  empty,                // 空字符串
+  invalid_character,    // 开头不是数字
+  trailing_characters,  // 数字之后还有多余的字符
+  out_of_range,         // 超出 T 的表示范围
+};
+
+inline const char *to_string(parse_error e) noexcept
+{
+  switch (e)
+  {
+    case parse_error::none:
+      return "none";
+    case parse_error::empty:
+      return "empty";
+    case parse_error::invalid_character:
+      return "invalid character";
+    case parse_error::trailing_characters:
+      return "trailing characters";
+    case parse_error::out_of_range:
+      return "out of range";
+  }
+  return "unknown";
+}
+
+template <typename T>
+struct parse_result
+{
+  T value{};
+  parse_error error = parse_error::none;
+
+  explicit operator bool() const noexcept
+  {
+    return error == parse_error::none;
+  }
+};
+
+namespace parse_detail
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool kSwar = false;  // SWAR 代码假设小端字节序
+#else
+constexpr bool kSwar = true;
+#endif
+
+inline bool isDigit(char c) noexcept
+{
+  return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+/// @brief 8 个字节是否全是 '0' ~ '9'
+inline bool isEightDigits(std::uint64_t chunk) noexcept
+{
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+/// @brief 把 8 个数字字符(内存中的第一个字节是最高位)转换成整数
+inline std::uint32_t parseEightDigits(std::uint64_t chunk) noexcept
+{
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);  // 相邻两位合并成 0~99
+  constexpr std::uint64_t kMask = 0x000000FF000000FFULL;
+  constexpr std::uint64_t kMul1 = 100 + (1000000ULL << 32);
+  constexpr std::uint64_t kMul2 = 1 + (10000ULL << 32);
+  return static_cast<std::uint32_t>((((chunk & kMask) * kMul1) + (((chunk >> 16) & kMask) * kMul2)) >> 32);
+}
+
+/// @brief 从 p 开始读取最多 n 个连续的数字累加到 value 中, 返回读取的个数. 调用者保证不会溢出(n <= 19)
+inline std::size_t parseDigits(const char *p, std::size_t n, std::uint64_t &value) noexcept
+{
+  std::size_t i = 0;
+  if constexpr (kSwar)
+  {
+    for (; i + 8 <= n; i += 8)
+    {
+      std::uint64_t chunk = 0;
+      std::memcpy(&chunk, p + i, 8);
+      if (!isEightDigits(chunk)) break;
+      value = value * 100000000 + parseEightDigits(chunk);
+    }
+  }
+  for (; i < n && isDigit(p[i]); ++i) value = value * 10 + static_cast<unsigned>(p[i] - '0');
+  return i;
+}
+
+inline parse_error fromErrc(std::errc ec, const char *ptr, const char *last) noexcept
+{
+  if (ec == std::errc::invalid_argument) return parse_error::invalid_character;
+  if (ec == std::errc::result_out_of_range) return parse_error::out_of_range;
+  return ptr != last ? parse_error::trailing_characters : parse_error::none;
+}
+
+constexpr std::size_t kMaxFastDigits = 19;  // 19 位十进制数一定小于 2^64
+
+template <typename T>
+parse_result<T> parseInteger(std::string_view sv) noexcept
+{
+  parse_result<T> result;
+  if (sv.empty())
+  {
+    result.error = parse_error::empty;
+    return result;
+  }
+  const char *p = sv.data();
+  std::size_t n = sv.size();
+  bool negative = false;
+  if constexpr (std::is_signed_v<T>)
+  {
+    if (*p == '-')
+    {
+      negative = true;
+      ++p;
+      --n;
+    }
+  }
+  if (n > kMaxFastDigits)
+  {
+    auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), result.value);
+    result.error = fromErrc(ec, ptr, sv.data() + sv.size());
+    return result;
+  }
+
+  std::uint64_t magnitude = 0;
+  const std::size_t digits = parseDigits(p, n, magnitude);
+  if (digits == 0)
+  {
+    result.error = parse_error::invalid_character;
+    return result;
+  }
+  using U = std::make_unsigned_t<T>;
+  const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+  if (magnitude > limit)
+    result.error = parse_error::out_of_range;  // 与 from_chars 一致: 先报告范围错误
+  else if (digits != n)
+    result.error = parse_error::trailing_characters;
+  else
+    result.value = static_cast<T>(negative ? static_cast<U>(0 - magnitude) : static_cast<U>(magnitude));
+  return result;
+}
+
+template <typename T>
+struct FloatLimits;
+template <>
+struct FloatLimits<double>
+{
+  static constexpr std::uint64_t kMaxMantissa = std::uint64_t{1} << 53;
+  static constexpr int kMaxPow10 = 22;
+};
+template <>
+struct FloatLimits<float>
+{
+  static constexpr std::uint64_t kMaxMantissa = std::uint64_t{1} << 24;
+  static constexpr int kMaxPow10 = 10;
+};
+
+/// @brief 10^k, k <= 22 时可以精确表示
+template <typename T>
+T exactPow10(int k) noexcept
+{
+  constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  return static_cast<T>(kPow10[k]);
+}
+
+#if !PARSE_HAS_FLOAT_FROM_CHARS
+/// @brief 没有浮点数 from_chars 时的慢速路径: 先检查格式, 再交给 strtod / strtof.
+/// strtod 需要以 '\0' 结尾的字符串, 超过 63 个字符的输入复制到临时的 std::string 中
+template <typename T>
+parse_result<T> parseFloatStrtod(std::string_view sv) noexcept
+{
+  parse_result<T> result;
+  // strtod 会跳过前导空白, 接受 '+' 和十六进制, 这些 from_chars 都不接受
+  const char first = sv.front();
+  if (first != '-' && first != '.' && !isDigit(first) && first != 'i' && first != 'I' && first != 'n' && first != 'N')
+  {
+    result.error = parse_error::invalid_character;
+    return result;
+  }
+  char buffer[64];
+  std::string heap;
+  const char *text = buffer;
+  if (sv.size() < sizeof(buffer))
+  {
+    std::memcpy(buffer, sv.data(), sv.size());
+    buffer[sv.size()] = '\0';
+  }
+  else
+  {
+    heap.assign(sv);
+    text = heap.c_str();
+  }
+  if (std::strpbrk(text, "xX") != nullptr)
+  {
+    result.error = parse_error::trailing_characters;  // 例如 "0x10": from_chars 只读取 "0", strtod 会按十六进制解析
+    return result;
+  }
+  char *end = nullptr;
+  errno = 0;
+  if constexpr (std::is_same_v<T, float>)
+    result.value = std::strtof(text, &end);
+  else
+    result.value = std::strtod(text, &end);
+  if (end == text)
+    result.error = parse_error::invalid_character;
+  else if (errno == ERANGE)
+    result.error = parse_error::out_of_range;
+  else if (end != text + sv.size())
+    result.error = parse_error::trailing_characters;
+  return result;
+}
+#endif
+
+template <typename T>
+parse_result<T> parseFloat(std::string_view sv) noexcept
+{
+  parse_result<T> result;
+  if (sv.empty())
+  {
+    result.error = parse_error::empty;
+    return result;
+  }
+  const char *p = sv.data();
+  std::size_t n = sv.size();
+  const bool negative = *p == '-';
+  if (negative)
+  {
+    ++p;
+    --n;
+  }
+
+  // 快速路径: [整数部分][.小数部分], 没有指数
+  std::uint64_t mantissa = 0;
+  const std::size_t integer_digits = parseDigits(p, std::min(n, kMaxFastDigits), mantissa);
+  std::size_t fraction_digits = 0;
+  std::size_t i = integer_digits;
+  if (i < n && p[i] == '.')
+  {
+    fraction_digits = parseDigits(p + i + 1, std::min(n - i - 1, kMaxFastDigits - integer_digits), mantissa);
+    i += 1 + fraction_digits;
+  }
+  if (i == n && integer_digits + fraction_digits > 0 && mantissa <= FloatLimits<T>::kMaxMantissa &&
+      static_cast<int>(fraction_digits) <= FloatLimits<T>::kMaxPow10)
+  {
+    T value = static_cast<T>(mantissa) / exactPow10<T>(static_cast<int>(fraction_digits));
+    result.value = negative ? -value : value;
+    return result;
+  }
+
+#if PARSE_HAS_FLOAT_FROM_CHARS
+  auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), result.value);
+  result.error = fromErrc(ec, ptr, sv.data() + sv.size());
+  return result;
+#else
+  return parseFloatStrtod<T>(sv);
+#endif
+}
+}  // namespace parse_detail
+
+/// @brief 把整个 sv 解析为 T(整数或 float / double)
+template <typename T>
+parse_result<T> parse(std::string_view sv) noexcept
+{
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse<T> requires an integer or floating type");
+  if constexpr (std::is_integral_v<T>)
+  {
+    return parse_detail::parseInteger<T>(sv);
+  }
+  else
+  {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "long double is not supported");
+    return parse_detail::parseFloat<T>(sv);
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * SIMD 公共设施: 平台检测, 按函数启用指令集, 运行时 CPU 特性检测, 位扫描.
+ *
+ * 编译时只假设基础指令集(x86-64 自带 SSE2), AVX2 代码用 SIMD_TARGET_AVX2 单独为函数开启,
+ * 运行时根据 simd::cpu() 的检测结果选择实现, 同一个二进制可以在不支持 AVX2 的机器上运行.
+ *   GCC / Clang: __attribute__((target("avx2"))) + __builtin_cpu_supports
+ *   MSVC       : 不需要编译选项即可使用 AVX2 intrinsics, 用 __cpuidex + _xgetbv 检测
+ *                (clang 以 MSVC 模式编译时也走这条路径, 避免依赖 compiler-rt 中的 __cpu_model)
+ * 非 x86-64 平台(例如 Apple Silicon) SIMD_X86 为 0, 只使用标量实现.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+#if SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
+namespace simd
+{
+#if SIMD_X86 && defined(_MSC_VER)
+#if defined(__clang__)
+__attribute__((target("xsave")))
+#endif
+inline unsigned long long readXcr0()
+{
+  return _xgetbv(0);
+}
+#endif
+
+/// @brief 运行时检测到的 CPU 特性
+struct CpuFeatures
+{
+  bool sse2 = false;
+  bool avx2 = false;
+};
+
+inline const CpuFeatures &cpu()
+{
+  static const CpuFeatures features = []
+  {
+    CpuFeatures f;
+#if SIMD_X86
+    f.sse2 = true;  // x86-64 的基础指令集
+#if !defined(_MSC_VER)
+    __builtin_cpu_init();
+    f.avx2 = __builtin_cpu_supports("avx2") != 0;
+#else
+    int regs[4] = {};
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool ymm_enabled = osxsave && (readXcr0() & 0x6) == 0x6;  // 操作系统保存 YMM 寄存器
+    __cpuidex(regs, 7, 0);
+    f.avx2 = ymm_enabled && (regs[1] & (1 << 5)) != 0;
+#endif
+#endif
+    return f;
+  }();
+  return features;
+}
+
+/// @brief 最低位 1 的位置, x 不能为 0
+inline unsigned countTrailingZeros(std::uint32_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward(&index, x);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+
+/// @brief 最高位 1 的位置(从 0 开始), x 不能为 0
+inline unsigned highestBit(std::uint32_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanReverse(&index, x);
+  return static_cast<unsigned>(index);
+#else
+  return 31U - static_cast<unsigned>(__builtin_clz(x));
+#endif
+}
+}  // namespace simd
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simd_common.hpp"
+
+/**
+ * SIMD 字节查找: 在一段内存中查找第一个等于 a 或 b 的字节(find_any), 用于分隔符 / 换行符 / 引号的查找.
+ *
+ * 做法与 memchr 相同: 一次比较 16 / 32 个字节, 比较结果用 movemask 压成位掩码, 最低位的 1 就是第一个命中的位置.
+ * memchr 只能查找一个字节, CSV 解析需要同时查找 "分隔符或换行" / "分隔符或引号", 这里一次比较两个字节.
+ * 运行时分派方式与 simd_trim.hpp 相同.
+ */
+namespace simd
+{
+namespace detail
+{
+inline std::size_t findAnyScalar(const char *p, std::size_t n, char a, char b) noexcept
+{
+  for (std::size_t i = 0; i < n; ++i)
+    if (p[i] == a || p[i] == b) return i;
+  return n;
+}
+
+#if SIMD_X86
+inline std::size_t findAnySse2(const char *p, std::size_t n, char a, char b) noexcept
+{
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));  // NOLINT
+    const auto mask = static_cast<std::uint32_t>(
+      _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb))));
+    if (mask != 0) return i + countTrailingZeros(mask);
+  }
+  return i + findAnyScalar(p + i, n - i, a, b);
+}
+
+SIMD_TARGET_AVX2 inline std::size_t findAnyAvx2(const char *p, std::size_t n, char a, char b) noexcept
+{
+  const __m256i va = _mm256_set1_epi8(a);
+  const __m256i vb = _mm256_set1_epi8(b);
+  std::size_t i = 0;
+  // 每次处理 64 字节: 两个向量的掩码拼成 64 位, 减少分支
+  for (; i + 64 <= n; i += 64)
+  {
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));       // NOLINT
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 32));  // NOLINT
+    const auto m0 = static_cast<std::uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v0, va), _mm256_cmpeq_epi8(v0, vb))));
+    const auto m1 = static_cast<std::uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v1, va), _mm256_cmpeq_epi8(v1, vb))));
+    if ((m0 | m1) != 0) return i + (m0 != 0 ? countTrailingZeros(m0) : 32 + countTrailingZeros(m1));
+  }
+  return i + findAnySse2(p + i, n - i, a, b);
+}
+#endif
+
+using FindAnyKernel = std::size_t (*)(const char *, std::size_t, char, char) noexcept;
+
+inline FindAnyKernel bestFindAny()
+{
+#if SIMD_X86
+  static const FindAnyKernel kernel = cpu().avx2 ? &findAnyAvx2 : &findAnySse2;
+  return kernel;
+#else
+  return &findAnyScalar;
+#endif
+}
+}  // namespace detail
+
+/// @brief 第一个等于 a 或 b 的字节的下标, 找不到时返回 n
+inline std::size_t find_any(const char *p, std::size_t n, char a, char b) noexcept
+{
+#if SIMD_X86
+  if (n < 64) return detail::findAnySse2(p, n, a, b);  // 短区间直接走内联的 SSE2
+#endif
+  return detail::bestFindAny()(p, n, a, b);
+}
+
+/// @brief 第一个等于 c 的字节的下标, 找不到时返回 n
+inline std::size_t find_byte(const char *p, std::size_t n, char c) noexcept
+{
+  return find_any(p, n, c, c);
+}
+}  // namespace simd
@@ -0,0 +1,181 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "simd_common.hpp"
+
+/**
+ * SIMD 版本的 trim / trim_left / trim_right.
+ *
+ * main.cpp 中的 trim 逐字节调用 std::isspace(依赖当前 locale), trim2 使用 find_first_not_of(对每个字节查找字符集合).
+ * 这里固定使用 C locale 的空白字符集合 " \t\n\r\f\v", 即 0x20 和 0x09~0x0D, 一次比较 16 / 32 个字节:
+ *   空白掩码 = (c == 0x20) | ((unsigned)(c - 0x09) <= 4)
+ *   非空白掩码取反后, 第一个非空白字节 = 最低位 1, 最后一个非空白字节 = 最高位 1.
+ * 不足一个向量宽度的部分用标量代码处理(同样不依赖 locale).
+ *
+ * 运行时分派: 第一次调用时根据 CPU 选择 AVX2 / SSE2 / 标量实现; 短字符串(< 16 字节)直接走内联的标量路径,
+ * 中等长度(< 64 字节)在 x86-64 上直接走内联的 SSE2, 只有长字符串才通过函数指针调用分派到的实现.
+ */
+namespace simd
+{
+namespace detail
+{
+inline bool isSpace(char c) noexcept
+{
+  const auto u = static_cast<unsigned char>(c);
+  return u == 0x20 || static_cast<unsigned char>(u - 0x09) <= 4;
+}
+
+/// @brief 第一个非空白字节的下标, 全是空白时返回 n
+inline std::size_t firstNonSpaceScalar(const char *p, std::size_t n) noexcept
+{
+  std::size_t i = 0;
+  while (i < n && isSpace(p[i])) ++i;
+  return i;
+}
+
+/// @brief 最后一个非空白字节的下标 + 1, 全是空白时返回 0
+inline std::size_t lastNonSpaceScalar(const char *p, std::size_t n) noexcept
+{
+  while (n > 0 && isSpace(p[n - 1])) --n;
+  return n;
+}
+
+#if SIMD_X86
+/// @brief 16 字节中非空白字节的位掩码
+inline std::uint32_t nonSpaceMask(__m128i v) noexcept
+{
+  const __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x20));
+  const __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(0x09));
+  const __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);  // 无符号 t <= 4
+  return ~static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(space, ctrl))) & 0xFFFFU;
+}
+
+inline std::size_t firstNonSpaceSse2(const char *p, std::size_t n) noexcept
+{
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    const std::uint32_t mask = nonSpaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)));  // NOLINT
+    if (mask != 0) return i + countTrailingZeros(mask);
+  }
+  return i + firstNonSpaceScalar(p + i, n - i);
+}
+
+inline std::size_t lastNonSpaceSse2(const char *p, std::size_t n) noexcept
+{
+  for (; n >= 16; n -= 16)
+  {
+    const std::uint32_t mask = nonSpaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + n - 16)));  // NOLINT
+    if (mask != 0) return n - 16 + highestBit(mask) + 1;
+  }
+  return lastNonSpaceScalar(p, n);
+}
+
+SIMD_TARGET_AVX2 inline std::uint32_t nonSpaceMask(__m256i v) noexcept
+{
+  const __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x20));
+  const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8(0x09));
+  const __m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+  return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(space, ctrl)));
+}
+
+SIMD_TARGET_AVX2 inline std::size_t firstNonSpaceAvx2(const char *p, std::size_t n) noexcept
+{
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    const std::uint32_t mask = nonSpaceMask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));  // NOLINT
+    if (mask != 0) return i + countTrailingZeros(mask);
+  }
+  return i + firstNonSpaceSse2(p + i, n - i);
+}
+
+SIMD_TARGET_AVX2 inline std::size_t lastNonSpaceAvx2(const char *p, std::size_t n) noexcept
+{
+  for (; n >= 32; n -= 32)
+  {
+    const auto *src = reinterpret_cast<const __m256i *>(p + n - 32);  // NOLINT
+    const std::uint32_t mask = nonSpaceMask(_mm256_loadu_si256(src));
+    if (mask != 0) return n - 32 + highestBit(mask) + 1;
+  }
+  return lastNonSpaceSse2(p, n);
+}
+#endif
+
+/// @brief 一组实现, 由运行时分派选择
+struct TrimKernels
+{
+  const char *name;
+  std::size_t (*first)(const char *, std::size_t) noexcept;
+  std::size_t (*last)(const char *, std::size_t) noexcept;
+};
+
+inline constexpr TrimKernels kScalarKernels{"scalar", &firstNonSpaceScalar, &lastNonSpaceScalar};
+#if SIMD_X86
+inline constexpr TrimKernels kSse2Kernels{"sse2", &firstNonSpaceSse2, &lastNonSpaceSse2};
+inline constexpr TrimKernels kAvx2Kernels{"avx2", &firstNonSpaceAvx2, &lastNonSpaceAvx2};
+#endif
+
+inline const TrimKernels &bestKernels()
+{
+#if SIMD_X86
+  static const TrimKernels &kernels = cpu().avx2 ? kAvx2Kernels : kSse2Kernels;
+  return kernels;
+#else
+  return kScalarKernels;
+#endif
+}
+
+constexpr std::size_t kShortString = 16;
+constexpr std::size_t kMediumString = 64;
+
+inline std::size_t firstNonSpace(const char *p, std::size_t n) noexcept
+{
+  if (n < kShortString) return firstNonSpaceScalar(p, n);
+#if SIMD_X86
+  if (n < kMediumString) return firstNonSpaceSse2(p, n);  // 内联的 SSE2, 省去间接调用和 AVX 状态切换
+#endif
+  return bestKernels().first(p, n);
+}
+
+inline std::size_t lastNonSpace(const char *p, std::size_t n) noexcept
+{
+  if (n < kShortString) return lastNonSpaceScalar(p, n);
+#if SIMD_X86
+  if (n < kMediumString) return lastNonSpaceSse2(p, n);
+#endif
+  return bestKernels().last(p, n);
+}
+}  // namespace detail
+
+inline std::string_view trim_left(std::string_view sv)
+{
+  return sv.substr(detail::firstNonSpace(sv.data(), sv.size()));
+}
+
+inline std::string_view trim_right(std::string_view sv)
+{
+  return sv.substr(0, detail::lastNonSpace(sv.data(), sv.size()));
+}
+
+inline std::string_view trim(std::string_view sv)
+{
+  return trim_right(trim_left(sv));
+}
+
+/// @brief 使用指定的实现去掉前后空白, 用于基准测试和对比各个实现的结果
+inline std::string_view trim_with(const detail::TrimKernels &kernels, std::string_view sv)
+{
+  const std::size_t start = kernels.first(sv.data(), sv.size());
+  sv.remove_prefix(start);
+  return sv.substr(0, kernels.last(sv.data(), sv.size()));
+}
+
+/// @brief 当前 CPU 上分派到的实现名称
+inline const char *trim_kernel_name()
+{
+  return detail::bestKernels().name;
+}
+}  // namespace simd
@@ -0,0 +1,341 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "simd_find.hpp"
+
+/**
+ * 零拷贝的惰性分词器: 所有结果都是指向源缓冲区的 string_view, 迭代过程中不分配内存.
+ * 源缓冲区必须在迭代期间保持有效.
+ *
+ *   for (std::string_view field : split_view(line, ','))  // 按分隔符切分, 保留空字段
+ *   for (std::string_view line : lines_view(text))        // 按行切分, 去掉行尾的 '\r', 文本末尾的换行不产生空行
+ *   for (const csv_field &f : csv_view(text))             // CSV(RFC 4180): 支持引号, 引号内的分隔符和换行
+ *
+ * 分隔符查找使用 simd::find_any(16 / 32 字节一次比较).
+ * CSV 中带转义引号("")的字段无法零拷贝地还原, 此时 csv_field::escaped 为 true, 需要时调用 unescape() 复制一份.
+ */
+namespace tokenizer
+{
+/// @brief 按单个字符切分, n 个分隔符产生 n + 1 个字段; 空字符串产生一个空字段
+class split_view
+{
+ public:
+  class iterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    iterator() = default;
+    iterator(std::string_view rest, char delim) : rest_(rest), delim_(delim), done_(false)
+    {
+      next();
+    }
+
+    reference operator*() const noexcept
+    {
+      return current_;
+    }
+    pointer operator->() const noexcept
+    {
+      return &current_;
+    }
+    iterator &operator++()
+    {
+      next();
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      next();
+      return old;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) noexcept
+    {
+      return a.done_ == b.done_ && (a.done_ || a.current_.data() == b.current_.data());
+    }
+    friend bool operator!=(const iterator &a, const iterator &b) noexcept
+    {
+      return !(a == b);
+    }
+
+   private:
+    void next()
+    {
+      if (finished_)
+      {
+        done_ = true;
+        return;
+      }
+      const std::size_t pos = simd::find_byte(rest_.data(), rest_.size(), delim_);
+      current_ = rest_.substr(0, pos);
+      if (pos == rest_.size())
+        finished_ = true;  // 最后一个字段
+      else
+        rest_.remove_prefix(pos + 1);
+    }
+
+    std::string_view rest_;
+    std::string_view current_;
+    char delim_ = ',';
+    bool finished_ = false;
+    bool done_ = true;
+  };
+
+  split_view(std::string_view text, char delim) noexcept : text_(text), delim_(delim) {}
+
+  [[nodiscard]] iterator begin() const
+  {
+    return {text_, delim_};
+  }
+  [[nodiscard]] iterator end() const noexcept
+  {
+    return {};
+  }
+
+ private:
+  std::string_view text_;
+  char delim_;
+};
+
+/// @brief 按 '\n' 切分行, 去掉行尾的 '\r'
+class lines_view
+{
+ public:
+  class iterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    iterator() = default;
+    explicit iterator(std::string_view rest) : rest_(rest)
+    {
+      next();
+    }
+
+    reference operator*() const noexcept
+    {
+      return current_;
+    }
+    pointer operator->() const noexcept
+    {
+      return &current_;
+    }
+    iterator &operator++()
+    {
+      next();
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      next();
+      return old;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) noexcept
+    {
+      return a.done_ == b.done_ && (a.done_ || a.current_.data() == b.current_.data());
+    }
+    friend bool operator!=(const iterator &a, const iterator &b) noexcept
+    {
+      return !(a == b);
+    }
+
+   private:
+    void next()
+    {
+      if (rest_.empty())
+      {
+        done_ = true;
+        return;
+      }
+      done_ = false;
+      const std::size_t pos = simd::find_byte(rest_.data(), rest_.size(), '\n');
+      current_ = rest_.substr(0, pos);
+      if (!current_.empty() && current_.back() == '\r') current_.remove_suffix(1);
+      rest_.remove_prefix(pos == rest_.size() ? pos : pos + 1);
+    }
+
+    std::string_view rest_;
+    std::string_view current_;
+    bool done_ = true;
+  };
+
+  explicit lines_view(std::string_view text) noexcept : text_(text) {}
+
+  [[nodiscard]] iterator begin() const
+  {
+    return iterator(text_);
+  }
+  [[nodiscard]] iterator end() const noexcept
+  {
+    return {};
+  }
+
+ private:
+  std::string_view text_;
+};
+
+/// @brief CSV 字段
+struct csv_field
+{
+  std::string_view value;      // 字段内容(带引号的字段不含外层引号)
+  bool quoted = false;         // 字段是否被引号包围
+  bool escaped = false;        // value 中含有需要还原的 ""
+  bool end_of_record = false;  // 是否是一条记录(一行)的最后一个字段
+};
+
+/// @brief 把带转义引号的字段还原成 std::string("" -> ")
+inline std::string unescape(const csv_field &field)
+{
+  if (!field.escaped) return std::string(field.value);
+  std::string out;
+  out.reserve(field.value.size());
+  for (std::size_t i = 0; i < field.value.size(); ++i)
+  {
+    out += field.value[i];
+    if (field.value[i] == '"') ++i;  // 跳过成对引号中的第二个
+  }
+  return out;
+}
+
+/// @brief 逐个字段遍历整段 CSV 文本, 引号内可以包含分隔符和换行
+class csv_view
+{
+ public:
+  class iterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = csv_field;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const csv_field *;
+    using reference = const csv_field &;
+
+    iterator() = default;
+    iterator(std::string_view rest, char delim) : rest_(rest), delim_(delim)
+    {
+      next();
+    }
+
+    reference operator*() const noexcept
+    {
+      return current_;
+    }
+    pointer operator->() const noexcept
+    {
+      return &current_;
+    }
+    iterator &operator++()
+    {
+      next();
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      next();
+      return old;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) noexcept
+    {
+      return a.done_ == b.done_ && (a.done_ || a.rest_.data() == b.rest_.data());
+    }
+    friend bool operator!=(const iterator &a, const iterator &b) noexcept
+    {
+      return !(a == b);
+    }
+
+   private:
+    void next()
+    {
+      // 上一个字段以分隔符结尾时, 即使已经到了末尾, 也还有一个空字段
+      if (rest_.empty() && !pending_empty_)
+      {
+        done_ = true;
+        return;
+      }
+      done_ = false;
+      pending_empty_ = false;
+      current_ = csv_field{};
+      std::size_t stop = 0;
+      if (!rest_.empty() && rest_.front() == '"')
+      {
+        current_.quoted = true;
+        // 查找结束引号, "" 是转义的引号
+        std::size_t pos = 1;
+        for (;;)
+        {
+          pos += simd::find_byte(rest_.data() + pos, rest_.size() - pos, '"');
+          if (pos + 1 < rest_.size() && rest_[pos + 1] == '"')
+          {
+            current_.escaped = true;
+            pos += 2;
+            continue;
+          }
+          break;  // 找到结束引号或者到了末尾(不完整的引号字段, 取到末尾为止)
+        }
+        current_.value = rest_.substr(1, pos - 1);
+        stop = std::min(pos + 1, rest_.size());
+        // 结束引号之后到分隔符/换行之间的内容不符合格式, 忽略
+        stop += simd::find_any(rest_.data() + stop, rest_.size() - stop, delim_, '\n');
+      }
+      else
+      {
+        stop = simd::find_any(rest_.data(), rest_.size(), delim_, '\n');
+        current_.value = rest_.substr(0, stop);
+      }
+      if (stop == rest_.size())
+      {
+        current_.end_of_record = true;
+        rest_.remove_prefix(stop);
+      }
+      else if (rest_[stop] == '\n')
+      {
+        current_.end_of_record = true;
+        rest_.remove_prefix(stop + 1);
+      }
+      else
+      {
+        rest_.remove_prefix(stop + 1);
+        pending_empty_ = rest_.empty();
+      }
+      if (current_.end_of_record && !current_.quoted && !current_.value.empty() && current_.value.back() == '\r')
+        current_.value.remove_suffix(1);
+    }
+
+    std::string_view rest_;
+    csv_field current_;
+    char delim_ = ',';
+    bool pending_empty_ = false;
+    bool done_ = true;
+  };
+
+  explicit csv_view(std::string_view text, char delim = ',') noexcept : text_(text), delim_(delim) {}
+
+  [[nodiscard]] iterator begin() const
+  {
+    return {text_, delim_};
+  }
+  [[nodiscard]] iterator end() const noexcept
+  {
+    return {};
+  }
+
+ private:
+  std::string_view text_;
+  char delim_;
+};
+}  // namespace tokenizer
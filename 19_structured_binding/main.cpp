@@ -5,11 +5,21 @@
  * 但默认是“值语义”，你必须主动用 & 才能避免拷贝
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <random>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+#include "string_interner.hpp"
 
 struct Point
 {
@@ -24,6 +34,8 @@ Point getPoint()
 
 class MyClass;
 void test();
+void test_interner();
+void bench_interner();
 int main()
 {
   std::map<std::string, int> myMap = {{"apple", 5}, {"banana", 3}};
@@ -66,6 +78,8 @@ int main()
   std::cout << "x1 = " << x1 << ", y1 = " << y1 << "\n";
 
   test();
+  test_interner();
+  bench_interner();
 }
 
 // 为自定义类提供结构化绑定接口, 实现方式: 本质就是让类“看起来像 tuple”
@@ -172,4 +186,90 @@ void test()
   MyClass obj(30, "Alice", "123 Main St");
   auto [age, name] = obj;  // 结构化绑定会调用 get<N>() 来获取成员变量的值
   std::cout << "age = " << age << ", name = " << name << "\n";
-}
\ No newline at end of file
+}
+// 对 myMap 的 key 做字符串驻留: 多个线程并发驻留同一批字符串, 得到的 symbol 必须一致
+void test_interner()
+{
+  string_interner interner;
+  symbol apple = interner.intern("apple");
+  symbol banana = interner.intern(std::string("banana"));  // 内容相同, 来源不同也得到同一个 symbol
+  std::cout << "apple -> id " << apple.id() << ", banana -> id " << banana.id()
+            << ", intern(\"apple\") == apple: " << (interner.intern("apple") == apple) << "\n";
+
+  std::map<symbol, int> symbolMap = {{apple, 5}, {banana, 3}};
+  for (const auto &[sym, value] : symbolMap) std::cout << interner.view(sym) << ": " << value << "\n";
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; ++i) keys.push_back("key_" + std::to_string(i));
+  constexpr int kThreads = 4;
+  std::vector<std::vector<symbol>> results(kThreads, std::vector<symbol>(keys.size()));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t)
+  {
+    threads.emplace_back(
+      [&, t]
+      {
+        // 每个线程以不同的顺序插入, 制造同一个字符串的并发插入
+        std::vector<std::size_t> order(keys.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937(t));
+        for (std::size_t i : order) results[t][i] = interner.intern(keys[i]);
+      });
+  }
+  for (auto &th : threads) th.join();
+  std::size_t errors = 0;
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    for (int t = 1; t < kThreads; ++t) errors += results[t][i] != results[0][i] ? 1 : 0;
+    errors += interner.view(results[0][i]) != keys[i] ? 1 : 0;
+  }
+  std::cout << "concurrent intern: " << interner.size() << " strings, " << errors << " errors\n";
+}
+
+// map 查找: std::string key vs 驻留后的 symbol key
+void bench_interner()
+{
+  constexpr std::size_t kKeys = 4096;
+  constexpr std::size_t kLookups = 2'000'000;
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < kKeys; ++i) keys.push_back("inventory/category_" + std::to_string(i % 64) + "/item_" +
+                                                         std::to_string(i));
+  std::mt19937 rng(11);
+  std::vector<std::string_view> queries;  // 模拟从输入中解析出来的 key
+  for (std::size_t i = 0; i < kLookups; ++i) queries.emplace_back(keys[rng() % kKeys]);
+
+  string_interner interner;
+  std::map<std::string, int> stringMap;
+  std::map<std::string, int, std::less<>> transparentMap;
+  std::unordered_map<std::string, int> stringHash;
+  std::map<symbol, int> symbolMap;
+  std::unordered_map<symbol, int> symbolHash;
+  for (std::size_t i = 0; i < kKeys; ++i)
+  {
+    const symbol sym = interner.intern(keys[i]);
+    stringMap[keys[i]] = transparentMap[keys[i]] = stringHash[keys[i]] = static_cast<int>(i);
+    symbolMap[sym] = symbolHash[sym] = static_cast<int>(i);
+  }
+  std::vector<symbol> querySymbols;  // key 只驻留一次, 之后一直使用 symbol
+  for (std::string_view q : queries) querySymbols.push_back(interner.intern(q));
+
+  std::cout << "========== benchmark: " << kLookups << " lookups over " << kKeys << " keys ==========\n";
+  auto run = [&](const char *name, auto &&lookup)
+  {
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kLookups; ++i) sum += lookup(i);
+    auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << std::left << std::setw(48) << name << std::right << std::setw(8) << std::fixed
+              << std::setprecision(2) << ns / kLookups << " ns/op  (checksum " << sum << ")\n";
+  };
+  run("map<string>::find(std::string(sv))",
+      [&](std::size_t i) { return stringMap.find(std::string(queries[i]))->second; });
+  run("map<string, less<>>::find(sv)", [&](std::size_t i) { return transparentMap.find(queries[i])->second; });
+  run("map<symbol>::find(sym)", [&](std::size_t i) { return symbolMap.find(querySymbols[i])->second; });
+  run("unordered_map<string>::find(std::string(sv))",
+      [&](std::size_t i) { return stringHash.find(std::string(queries[i]))->second; });
+  run("unordered_map<symbol>::find(sym)", [&](std::size_t i) { return symbolHash.find(querySymbols[i])->second; });
+  run("interner.find(sv) + unordered_map<symbol>",
+      [&](std::size_t i) { return symbolHash.find(*interner.find(queries[i]))->second; });
+}
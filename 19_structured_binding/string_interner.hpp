@@ -0,0 +1,289 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 并发字符串驻留表(string interning): 相同内容的字符串只保存一份, 得到一个 32 位的 symbol 和永久有效的 string_view.
+ *
+ * std::map<std::string, int> 每次查找都要先把 key 转成 std::string, 再做若干次逐字节比较;
+ * 驻留之后 map 的 key 换成 symbol, 比较就是整数比较, 拷贝 key 也只是拷贝 4 个字节.
+ *
+ * 实现:
+ *   - 按哈希值的高 4 位分成 16 个分片, 每个分片一把互斥锁, 插入只锁所在的分片;
+ *   - 每个分片一张开放寻址哈希表, 槽位是 std::atomic<const Entry *>. 读路径(find / view)只做 acquire 读, 不加锁;
+ *   - 扩容时复制出一张新表再发布, 旧表不释放(保存到析构为止), 正在读旧表的线程不会访问到已释放的内存.
+ *     旧表中查不到的字符串由 intern() 在锁内的当前表中重新查找, 所以不会重复插入;
+ *   - 字符串内容保存在分片自己的内存块中, 永不移动, string_view 在驻留表销毁前一直有效;
+ *   - id = 分片内序号 << 4 | 分片号, 分片内序号到 Entry 的映射是分段数组(第 k 段 64 << k 个元素), 同样无锁读.
+ */
+
+/// @brief 驻留后的字符串句柄, 只比较 32 位 id
+class symbol
+{
+ public:
+  constexpr symbol() noexcept = default;
+  constexpr explicit symbol(std::uint32_t id) noexcept : id_(id) {}
+
+  [[nodiscard]] constexpr std::uint32_t id() const noexcept
+  {
+    return id_;
+  }
+
+  friend constexpr bool operator==(symbol a, symbol b) noexcept
+  {
+    return a.id_ == b.id_;
+  }
+  friend constexpr bool operator!=(symbol a, symbol b) noexcept
+  {
+    return a.id_ != b.id_;
+  }
+  friend constexpr bool operator<(symbol a, symbol b) noexcept
+  {
+    return a.id_ < b.id_;
+  }
+
+ private:
+  std::uint32_t id_ = 0;
+};
+
+namespace std
+{
+template <>
+struct hash<symbol>
+{
+  size_t operator()(symbol s) const noexcept
+  {
+    // id 的低 4 位是分片号, 乘以一个奇数常量把各个位打散
+    return static_cast<size_t>(s.id() * 0x9E3779B1U);
+  }
+};
+}  // namespace std
+
+class string_interner
+{
+ public:
+  string_interner() = default;
+  string_interner(const string_interner &) = delete;
+  string_interner &operator=(const string_interner &) = delete;
+
+  /// @brief 驻留字符串, 已存在时返回原来的 symbol
+  symbol intern(std::string_view s)
+  {
+    const std::uint64_t hash = hashOf(s);
+    Shard &shard = shards_[shardOf(hash)];
+    if (const Entry *e = shard.find(s, hash)) return symbol(e->id);  // 无锁快速路径
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return symbol(shard.insert(s, hash, shardOf(hash))->id);
+  }
+
+  /// @brief 只查找不插入, 无锁
+  [[nodiscard]] std::optional<symbol> find(std::string_view s) const
+  {
+    const std::uint64_t hash = hashOf(s);
+    if (const Entry *e = shards_[shardOf(hash)].find(s, hash)) return symbol(e->id);
+    return std::nullopt;
+  }
+
+  /// @brief symbol 对应的字符串, 无锁; sym 必须来自本驻留表. 返回的 string_view 以 '\0' 结尾
+  [[nodiscard]] std::string_view view(symbol sym) const noexcept
+  {
+    const Entry *e = shards_[sym.id() & (kShards - 1)].entry(sym.id() >> kShardBits);
+    return {e->chars(), e->size};
+  }
+
+  /// @brief 已驻留的字符串个数
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    std::size_t n = 0;
+    for (const Shard &shard : shards_) n += shard.count.load(std::memory_order_relaxed);
+    return n;
+  }
+
+ private:
+  static constexpr unsigned kShardBits = 4;
+  static constexpr std::size_t kShards = std::size_t{1} << kShardBits;
+  static constexpr unsigned kFirstSegmentBits = 6;
+  static constexpr std::size_t kSegments = 32 - kShardBits - kFirstSegmentBits + 1;
+  static constexpr std::size_t kBlockSize = 64 * 1024;
+
+  /// @brief 驻留的字符串, 字符紧跟在结构体后面
+  struct Entry
+  {
+    std::uint64_t hash;
+    std::uint32_t id;
+    std::uint32_t size;
+
+    [[nodiscard]] const char *chars() const noexcept
+    {
+      return reinterpret_cast<const char *>(this + 1);  // NOLINT
+    }
+  };
+
+  /// @brief 开放寻址哈希表, 容量是 2 的幂, 负载因子不超过 1/2
+  struct Table
+  {
+    explicit Table(std::size_t capacity) : mask(capacity - 1), slots(new std::atomic<const Entry *>[capacity])
+    {
+      for (std::size_t i = 0; i < capacity; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    std::size_t mask;
+    std::unique_ptr<std::atomic<const Entry *>[]> slots;
+  };
+
+  struct Shard
+  {
+    Shard()
+    {
+      tables.push_back(std::make_unique<Table>(64));
+      table.store(tables.back().get(), std::memory_order_relaxed);
+      for (auto &segment : segments) segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~Shard()
+    {
+      for (auto &segment : segments) delete[] segment.load(std::memory_order_relaxed);
+    }
+
+    const Entry *find(std::string_view s, std::uint64_t hash) const
+    {
+      const Table *t = table.load(std::memory_order_acquire);
+      for (std::size_t i = hash & t->mask;; i = (i + 1) & t->mask)
+      {
+        const Entry *e = t->slots[i].load(std::memory_order_acquire);
+        if (e == nullptr) return nullptr;
+        if (e->hash == hash && std::string_view(e->chars(), e->size) == s) return e;
+      }
+    }
+
+    /// @brief 持有 mutex 时调用
+    const Entry *insert(std::string_view s, std::uint64_t hash, std::size_t shard_index)
+    {
+      if (const Entry *e = find(s, hash)) return e;  // 其他线程可能刚刚插入
+      const std::uint32_t local = count.load(std::memory_order_relaxed);
+      assert(local < (std::uint32_t{1} << (32 - kShardBits)) && "too many strings in one shard");
+
+      Table *t = table.load(std::memory_order_relaxed);
+      if ((local + 1) * 2 > t->mask + 1) t = grow(*t);
+
+      const Entry *e = makeEntry(s, hash, local << kShardBits | static_cast<std::uint32_t>(shard_index));
+      // 先发布 id -> Entry, 再发布 字符串 -> Entry: 读线程拿到 id 时 view(id) 一定可用
+      const auto [k, offset] = locate(local);
+      std::atomic<const Entry *> *segment = segments[k].load(std::memory_order_relaxed);
+      if (segment == nullptr)
+      {
+        segment = new std::atomic<const Entry *>[std::size_t{1} << (k + kFirstSegmentBits)];
+        segments[k].store(segment, std::memory_order_release);
+      }
+      segment[offset].store(e, std::memory_order_release);
+      std::size_t i = hash & t->mask;
+      while (t->slots[i].load(std::memory_order_relaxed) != nullptr) i = (i + 1) & t->mask;
+      t->slots[i].store(e, std::memory_order_release);
+      count.store(local + 1, std::memory_order_release);
+      return e;
+    }
+
+    const Entry *entry(std::uint32_t local) const noexcept
+    {
+      const auto [k, offset] = locate(local);
+      return segments[k].load(std::memory_order_acquire)[offset].load(std::memory_order_acquire);
+    }
+
+    /// @brief 序号 local 所在的段和段内偏移, 第 k 段容量为 64 << k
+    static std::pair<unsigned, std::size_t> locate(std::uint32_t local) noexcept
+    {
+      const std::uint64_t j = std::uint64_t{local} + (std::uint64_t{1} << kFirstSegmentBits);
+      unsigned k = 0;
+      while ((j >> (k + kFirstSegmentBits + 1)) != 0) ++k;
+      return {k, static_cast<std::size_t>(j - (std::uint64_t{1} << (k + kFirstSegmentBits)))};
+    }
+
+    Table *grow(const Table &old)
+    {
+      auto bigger = std::make_unique<Table>((old.mask + 1) * 2);
+      for (std::size_t i = 0; i <= old.mask; ++i)
+      {
+        const Entry *e = old.slots[i].load(std::memory_order_relaxed);
+        if (e == nullptr) continue;
+        std::size_t j = e->hash & bigger->mask;
+        while (bigger->slots[j].load(std::memory_order_relaxed) != nullptr) j = (j + 1) & bigger->mask;
+        bigger->slots[j].store(e, std::memory_order_relaxed);
+      }
+      Table *t = bigger.get();
+      tables.push_back(std::move(bigger));
+      table.store(t, std::memory_order_release);
+      return t;
+    }
+
+    const Entry *makeEntry(std::string_view s, std::uint64_t hash, std::uint32_t id)
+    {
+      std::size_t bytes = sizeof(Entry) + s.size() + 1;
+      bytes = (bytes + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+      if (bytes > remaining)
+      {
+        const std::size_t block_size = bytes > kBlockSize / 4 ? bytes : kBlockSize;
+        blocks.emplace_back(new char[block_size]);
+        cursor = blocks.back().get();
+        remaining = block_size;
+      }
+      auto *e = new (cursor) Entry{hash, id, static_cast<std::uint32_t>(s.size())};
+      std::memcpy(cursor + sizeof(Entry), s.data(), s.size());
+      cursor[sizeof(Entry) + s.size()] = '\0';
+      cursor += bytes;
+      remaining -= bytes;
+      return e;
+    }
+
+    std::mutex mutex;
+    std::atomic<Table *> table{nullptr};
+    std::vector<std::unique_ptr<Table>> tables;  // 包括已被替换的旧表
+    std::atomic<std::atomic<const Entry *> *> segments[kSegments];
+    std::atomic<std::uint32_t> count{0};
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *cursor = nullptr;
+    std::size_t remaining = 0;
+  };
+
+  static std::uint64_t hashOf(std::string_view s) noexcept
+  {
+    // 每次读取 8 个字节做乘法混合, 最后用 murmur3 的 finalizer 打散: 高位用于选择分片, 低位用于哈希表下标
+    constexpr std::uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t h = s.size() * kMul;
+    std::size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8)
+    {
+      std::uint64_t word = 0;
+      std::memcpy(&word, s.data() + i, 8);
+      h = (h ^ word) * kMul;
+      h ^= h >> 29;
+    }
+    if (i < s.size())
+    {
+      std::uint64_t word = 0;
+      std::memcpy(&word, s.data() + i, s.size() - i);
+      h = (h ^ word) * kMul;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static std::size_t shardOf(std::uint64_t hash) noexcept
+  {
+    return static_cast<std::size_t>(hash >> (64 - kShardBits));
+  }
+
+  Shard shards_[kShards];
+};
@@ -0,0 +1,478 @@
+#pragma once
+
+/**
+ * async_io: 基于 io_uring 的异步文件 I/O, 每个请求返回一个 std::future.
+ *
+ * 阻塞的 pread / pwrite 每次操作都是一次系统调用, 线程在 I/O 完成前什么也做不了.
+ * io_uring 是 Linux 5.1 引入的异步 I/O 接口, 用户态和内核共享两个环形队列:
+ *   - 提交队列(SQ): 用户态填写请求(SQE), 一次 io_uring_enter 可以提交一批请求.
+ *   - 完成队列(CQ): 内核写入完成事件(CQE), 用户态直接读取, 不需要额外的系统调用.
+ * 这里不依赖 liburing, 直接使用 io_uring_setup / io_uring_enter / io_uring_register 三个系统调用.
+ *
+ * 用法:
+ *   async_io io;                                           // 自动选择 io_uring, 不可用时退回线程池
+ *   auto f = io.prepareRead(fd, buf, 4096, offset);        // 只填写请求
+ *   io.submit();                                           // 一次系统调用提交所有已准备的请求
+ *   ssize_t n = f.get();                                   // 成功返回字节数, 失败返回 -errno
+ *   io.read(...) / io.write(...) / io.fsync(...)           // 准备 + 立即提交
+ *
+ * 注册缓冲区(registerBuffers + prepareReadFixed): 内核预先固定(pin)缓冲区的物理页,
+ * 之后每次读写不再需要映射/固定用户页, 即 "零拷贝" 路径上省掉的那部分开销.
+ *
+ * 后端:
+ *   - io_uring   : 需要 Linux 5.6+(IORING_OP_READ / IORING_OP_WRITE), 后台线程收割完成事件.
+ *   - thread_pool: io_uring 不可用(内核太旧, seccomp 禁止, 非 Linux)时的退路, 工作线程执行阻塞的 pread / pwrite.
+ *     epoll 对普通文件总是返回 "就绪", 不能用来做文件的异步 I/O, 所以退路使用线程池.
+ * 请求的缓冲区必须在对应的 future 就绪前保持有效.
+ * C++17 没有协程, 这里使用 std::future; 升级到 C++20 后可以在同一个完成回调上包装 awaitable.
+ */
+
+#if defined(_WIN32)
+#define ASYNC_IO_SUPPORTED 0
+#else
+#define ASYNC_IO_SUPPORTED 1
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_IO_HAS_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#else
+#define ASYNC_IO_HAS_URING 0
+#endif
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+class async_io
+{
+ public:
+  enum class backend
+  {
+    automatic,    // 优先 io_uring
+    io_uring,     // 必须使用 io_uring, 不可用时抛出 std::system_error
+    thread_pool,  // 强制使用线程池
+  };
+
+  explicit async_io(backend choice = backend::automatic, unsigned queue_depth = 256, unsigned pool_threads = 4)
+  {
+#if ASYNC_IO_HAS_URING
+    if (choice != backend::thread_pool)
+    {
+      const int error = setupRing(queue_depth);
+      if (error == 0)
+      {
+        reaper_ = std::thread([this] { reapLoop(); });
+        return;
+      }
+      if (choice == backend::io_uring) throw std::system_error(error, std::generic_category(), "io_uring_setup");
+    }
+#else
+    if (choice == backend::io_uring) throw std::system_error(ENOSYS, std::generic_category(), "io_uring");
+#endif
+    (void)queue_depth;
+    for (unsigned i = 0; i < pool_threads; ++i) workers_.emplace_back([this] { workerLoop(); });
+  }
+
+  async_io(const async_io &) = delete;
+  async_io &operator=(const async_io &) = delete;
+
+  ~async_io()
+  {
+#if ASYNC_IO_HAS_URING
+    if (ring_fd_ >= 0)
+    {
+      {
+        // 提交剩下的请求(提交失败的请求在 submitLocked 中直接完成), 收割线程等在途请求全部完成后退出
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        submitLocked();
+      }
+      reap_cv_.notify_all();
+      reaper_.join();
+      teardownRing();
+      return;
+    }
+#endif
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &w : workers_) w.join();
+  }
+
+  /// @brief 当前是否在使用 io_uring 后端
+  [[nodiscard]] bool usingIoUring() const noexcept
+  {
+#if ASYNC_IO_HAS_URING
+    return ring_fd_ >= 0;
+#else
+    return false;
+#endif
+  }
+
+  std::future<ssize_t> prepareRead(int fd, void *buf, std::size_t len, off_t offset)
+  {
+#if ASYNC_IO_HAS_URING
+    if (usingIoUring()) return prepareRw(IORING_OP_READ, fd, buf, len, offset, 0);
+#endif
+    return enqueue([=] { return resultOf(::pread(fd, buf, len, offset)); });
+  }
+
+  std::future<ssize_t> prepareWrite(int fd, const void *buf, std::size_t len, off_t offset)
+  {
+#if ASYNC_IO_HAS_URING
+    if (usingIoUring()) return prepareRw(IORING_OP_WRITE, fd, const_cast<void *>(buf), len, offset, 0);
+#endif
+    return enqueue([=] { return resultOf(::pwrite(fd, buf, len, offset)); });
+  }
+
+  std::future<ssize_t> prepareFsync(int fd)
+  {
+#if ASYNC_IO_HAS_URING
+    if (usingIoUring()) return prepareRw(IORING_OP_FSYNC, fd, nullptr, 0, 0, 0);
+#endif
+    return enqueue([=] { return static_cast<ssize_t>(resultOf(::fsync(fd))); });
+  }
+
+  /// @brief 使用已注册的缓冲区读取, buf 必须位于第 buf_index 个注册缓冲区内
+  std::future<ssize_t> prepareReadFixed(int fd, unsigned buf_index, void *buf, std::size_t len, off_t offset)
+  {
+#if ASYNC_IO_HAS_URING
+    if (usingIoUring() && buffers_registered_)
+      return prepareRw(IORING_OP_READ_FIXED, fd, buf, len, offset, buf_index);
+#endif
+    return prepareRead(fd, buf, len, offset);
+  }
+
+  /// @brief 注册固定缓冲区, 成功返回 0, 失败返回 -errno(例如 RLIMIT_MEMLOCK 不足);
+  /// 线程池后端或注册失败时 prepareReadFixed 退化为普通读取
+  int registerBuffers(const std::vector<iovec> &buffers)
+  {
+#if ASYNC_IO_HAS_URING
+    if (!usingIoUring()) return -ENOSYS;
+    const long ret = ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, buffers.data(),
+                               static_cast<unsigned>(buffers.size()));
+    if (ret < 0) return -errno;
+    buffers_registered_ = true;
+    return 0;
+#else
+    (void)buffers;
+    return -ENOSYS;
+#endif
+  }
+
+  /// @brief 提交所有已准备的请求(线程池后端下请求在准备时就已经排队, 这里什么也不做)
+  void submit()
+  {
+#if ASYNC_IO_HAS_URING
+    if (usingIoUring())
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      submitLocked();
+    }
+#endif
+  }
+
+  std::future<ssize_t> read(int fd, void *buf, std::size_t len, off_t offset)
+  {
+    auto f = prepareRead(fd, buf, len, offset);
+    submit();
+    return f;
+  }
+
+  std::future<ssize_t> write(int fd, const void *buf, std::size_t len, off_t offset)
+  {
+    auto f = prepareWrite(fd, buf, len, offset);
+    submit();
+    return f;
+  }
+
+  std::future<ssize_t> fsync(int fd)
+  {
+    auto f = prepareFsync(fd);
+    submit();
+    return f;
+  }
+
+ private:
+  /// @brief 系统调用失败时返回 -errno, 与 io_uring 完成事件的约定一致
+  static ssize_t resultOf(ssize_t ret)
+  {
+    return ret < 0 ? -errno : ret;
+  }
+
+  // ---------------- 线程池后端 ----------------
+
+  template <typename F>
+  std::future<ssize_t> enqueue(F &&op)
+  {
+    std::packaged_task<ssize_t()> task(std::forward<F>(op));
+    auto future = task.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+    return future;
+  }
+
+  void workerLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+      work_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::deque<std::packaged_task<ssize_t()>> tasks_;
+  std::vector<std::thread> workers_;
+  bool stop_ = false;  // 析构开始, 两种后端共用
+
+#if ASYNC_IO_HAS_URING
+  // ---------------- io_uring 后端 ----------------
+
+  struct Request
+  {
+    std::promise<ssize_t> promise;
+  };
+
+  static unsigned loadAcquire(const unsigned *p) noexcept
+  {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  static void storeRelease(unsigned *p, unsigned v) noexcept
+  {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+  }
+
+  /// @brief 创建 io_uring 并映射共享队列, 成功返回 0, 失败返回 errno
+  int setupRing(unsigned entries)
+  {
+    io_uring_params params = {};
+    const long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return errno;
+    ring_fd_ = static_cast<int>(fd);
+    // IORING_FEAT_RW_CUR_POS 与 IORING_OP_READ / IORING_OP_WRITE 同在 5.6 引入, 用来判断内核是否足够新
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+    {
+      teardownRing();
+      return ENOSYS;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+    sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) return failSetup();
+    cq_ring_ = single_mmap ? sq_ring_
+                           : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return failSetup();
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return failSetup();
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<std::byte *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);  // NOLINT
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);  // NOLINT
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);  // NOLINT
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);  // NOLINT
+    sq_entries_ = params.sq_entries;
+    auto *cq = static_cast<std::byte *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);  // NOLINT
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);  // NOLINT
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);  // NOLINT
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);  // NOLINT
+    cq_entries_ = params.cq_entries;
+    return 0;
+  }
+
+  int failSetup()
+  {
+    const int error = errno;
+    teardownRing();
+    return error;
+  }
+
+  void teardownRing() noexcept
+  {
+    if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_size_);
+    sqes_ = nullptr;
+    sq_ring_ = cq_ring_ = nullptr;
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+    ring_fd_ = -1;
+  }
+
+  long enter(unsigned to_submit, unsigned min_complete, unsigned flags) const noexcept
+  {
+    return ::syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0);
+  }
+
+  /// @brief 取一个空闲的 SQE; 在途请求达到 CQ 容量时先提交并等待, 保证完成队列不会溢出
+  io_uring_sqe *acquireSqe(std::unique_lock<std::mutex> &lock)
+  {
+    if (in_flight_ >= cq_entries_)
+    {
+      submitLocked();
+      slot_cv_.wait(lock, [this] { return in_flight_ < cq_entries_; });
+    }
+    unsigned tail = *sq_tail_;
+    if (tail - loadAcquire(sq_head_) >= sq_entries_)
+    {
+      submitLocked();  // 非 SQPOLL 模式下, 提交后内核立即消费 SQE
+      tail = *sq_tail_;
+    }
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    storeRelease(sq_tail_, tail + 1);  // 调用方在持有锁期间填写 SQE, 由下一次 io_uring_enter 提交
+    ++pending_;
+    ++in_flight_;
+    return sqe;
+  }
+
+  std::future<ssize_t> prepareRw(std::uint8_t opcode, int fd, void *buf, std::size_t len, off_t offset,
+                                 unsigned buf_index)
+  {
+    auto *request = new Request;
+    auto future = request->promise.get_future();
+    std::unique_lock<std::mutex> lock(mutex_);
+    io_uring_sqe *sqe = acquireSqe(lock);
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(buf);  // NOLINT
+    sqe->len = static_cast<std::uint32_t>(len);
+    sqe->off = static_cast<std::uint64_t>(offset);
+    sqe->buf_index = static_cast<std::uint16_t>(buf_index);
+    sqe->user_data = reinterpret_cast<std::uint64_t>(request);  // NOLINT
+    return future;
+  }
+
+  void submitLocked()
+  {
+    bool submitted = false;
+    while (pending_ > 0)
+    {
+      const long ret = enter(pending_, 0, 0);
+      if (ret < 0)
+      {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+        failPending(errno);
+        break;
+      }
+      pending_ -= static_cast<unsigned>(ret);
+      submitted = submitted || ret > 0;
+    }
+    if (submitted) reap_cv_.notify_one();
+  }
+
+  /// @brief io_uring_enter 出错时内核没有消费的 SQE 就是队列尾部的 pending_ 个: 把它们撤回,
+  /// 对应的 future 直接得到 -error, 否则这些请求永远不会完成, 析构函数也会一直等下去
+  void failPending(int error)
+  {
+    unsigned tail = *sq_tail_;
+    for (; pending_ > 0; --pending_, --in_flight_)
+    {
+      --tail;
+      auto *request = reinterpret_cast<Request *>(sqes_[tail & sq_mask_].user_data);  // NOLINT
+      request->promise.set_value(-error);
+      delete request;
+    }
+    storeRelease(sq_tail_, tail);
+    slot_cv_.notify_all();
+  }
+
+  /// @brief 收割线程: 等待完成事件, 设置对应 future 的结果; 析构开始且没有在途请求时退出.
+  /// 只有确实有请求交给了内核(in_flight_ > pending_)时才在 io_uring_enter 中等待, 否则在 reap_cv_ 上等待
+  void reapLoop()
+  {
+    for (;;)
+    {
+      unsigned head = *cq_head_;
+      const unsigned tail = loadAcquire(cq_tail_);
+      if (head == tail)
+      {
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          reap_cv_.wait(lock, [this] { return in_flight_ > pending_ || (stop_ && in_flight_ == 0); });
+          if (in_flight_ == 0) return;
+        }
+        enter(0, 1, IORING_ENTER_GETEVENTS);
+        continue;
+      }
+      unsigned reaped = 0;
+      for (; head != tail; ++head, ++reaped)
+      {
+        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        auto *request = reinterpret_cast<Request *>(cqe.user_data);  // NOLINT
+        request->promise.set_value(cqe.res);
+        delete request;
+      }
+      storeRelease(cq_head_, head);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_ -= reaped;
+      }
+      slot_cv_.notify_all();
+    }
+  }
+
+  int ring_fd_ = -1;
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  std::size_t sq_ring_size_ = 0;
+  std::size_t cq_ring_size_ = 0;
+  std::size_t sqes_size_ = 0;
+  io_uring_sqe *sqes_ = nullptr;
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+  unsigned cq_mask_ = 0;
+  unsigned cq_entries_ = 0;
+  unsigned pending_ = 0;    // 已填写但还没提交的 SQE 数量
+  unsigned in_flight_ = 0;  // 已填写但还没收割的请求数量
+  bool buffers_registered_ = false;
+  std::condition_variable slot_cv_;
+  std::condition_variable reap_cv_;  // 有请求交给内核或析构开始时唤醒收割线程
+  std::thread reaper_;
+#endif
+};
+#endif
@@ -0,0 +1,775 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BTREE_SSE2 1
+#include <emmintrin.h>
+#else
+#define BTREE_SSE2 0
+#endif
+
+/**
+ * B+ 树实现的有序 map(接口参考 std::map), 适合大量 key 上的范围查询.
+ *
+ * std::map 每个元素一个节点, 查找 100 万个 key 要沿着指针访问约 20 个分散的节点, 范围扫描也是一个节点一个节点地跳;
+ * B+ 树的每个节点保存几十个 key:
+ *   - 节点按缓存行(64 字节)对齐, key 数组正好占 4 条缓存行(uint64 为 32 个 key, int32 为 64 个), 100 万个 key 只有 4 层;
+ *   - 节点内的查找: key 是 32 / 64 位整数且使用默认比较时, 用 SSE2 一次比较 4 个(或 2 个) key, 统计小于目标的个数,
+ *     没有分支; 其他 key 类型在节点内二分查找. 非 x86 平台用普通的计数循环(编译器通常会自动向量化);
+ *   - 元素只保存在叶子中, 叶子之间是双向链表, 范围扫描就是顺序读叶子内的数组, 正向反向都可以;
+ *   - 批量构建: 排序一次后直接把叶子填满, 再自底向上生成内部节点, O(n log n), 重复的 key 保留第一个.
+ * 内部节点中的分隔 key 是右侧子树的最小 key(只用于导航, 删除元素后不需要更新).
+ * 删除时只回收变空的节点, 不合并半空的节点; 大量删除之后可以重新批量构建.
+ * 解引用迭代器得到 std::pair<const Key &, T &>(临时对象), 结构化绑定写成 const auto &[key, value] 或 auto [key, value].
+ * 节点内的数组是预先构造的, Key 和 T 需要可默认构造和移动赋值; 插入和删除会使迭代器失效.
+ */
+
+namespace btree_detail
+{
+#if BTREE_SSE2
+/// @brief 无符号数比较前把最高位取反, 转换成有符号比较
+template <typename Key>
+inline __m128i bias(__m128i v) noexcept
+{
+  if constexpr (std::is_signed_v<Key>) return v;
+  if constexpr (sizeof(Key) == 4) return _mm_xor_si128(v, _mm_set1_epi32(INT32_MIN));
+  return _mm_xor_si128(v, _mm_set_epi32(INT32_MIN, 0, INT32_MIN, 0));
+}
+
+/// @brief 每个通道 a > b(有符号)时全为 1
+template <typename Key>
+inline __m128i greaterThan(__m128i a, __m128i b) noexcept
+{
+  if constexpr (sizeof(Key) == 4)
+  {
+    return _mm_cmpgt_epi32(a, b);
+  }
+  else
+  {
+    // SSE2 没有 64 位比较(_mm_cmpgt_epi64 需要 SSE4.2): 高 32 位有符号比较; 高 32 位相等时,
+    // b - a 的高 32 位在 a 的低 32 位(无符号)更大时产生借位, 变成全 1. 最后把高 32 位的结果复制到整个通道
+    __m128i r = _mm_and_si128(_mm_cmpeq_epi32(a, b), _mm_sub_epi64(b, a));
+    r = _mm_or_si128(r, _mm_cmpgt_epi32(a, b));
+    return _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 1, 1));
+  }
+}
+#endif
+
+/// @brief keys[0, n) 已排序, Upper 为 false 时返回 keys[i] < key 的个数(lower_bound), 为 true 时返回 keys[i] <= key 的个数
+template <bool Upper, typename Key>
+inline std::uint32_t simdRank(const Key *keys, std::uint32_t n, Key key) noexcept
+{
+  std::uint32_t count = 0;
+  std::uint32_t i = 0;
+#if BTREE_SSE2
+  constexpr std::uint32_t kLanes = 16 / sizeof(Key);
+  const __m128i needle = bias<Key>(sizeof(Key) == 4 ? _mm_set1_epi32(static_cast<std::int32_t>(key))
+                                                     : _mm_set1_epi64x(static_cast<std::int64_t>(key)));
+  __m128i acc = _mm_setzero_si128();
+  for (; i + kLanes <= n; i += kLanes)
+  {
+    const __m128i k = bias<Key>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)));
+    // 比较结果为 true 的通道是 -1, 减去它就是计数加 1. upper_bound 统计 keys[i] > key 的个数, 最后从总数中减去
+    const __m128i hit = Upper ? greaterThan<Key>(k, needle) : greaterThan<Key>(needle, k);
+    acc = sizeof(Key) == 4 ? _mm_sub_epi32(acc, hit) : _mm_sub_epi64(acc, hit);
+  }
+  std::make_unsigned_t<Key> lanes[kLanes];
+  std::memcpy(lanes, &acc, sizeof(acc));
+  for (auto lane : lanes) count += static_cast<std::uint32_t>(lane);
+  if (Upper) count = i - count;
+#endif
+  // 剩余不足一组的 key(非 x86 平台是全部 key): 无分支地计数
+  for (; i < n; ++i) count += static_cast<std::uint32_t>(Upper ? !(key < keys[i]) : keys[i] < key);
+  return count;
+}
+}  // namespace btree_detail
+
+template <typename Key, typename T, typename Compare = std::less<>>
+class btree_map
+{
+  static constexpr std::size_t kCacheLine = 64;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+
+  /// @brief 每个节点的 key 个数: key 数组占 4 条缓存行
+  static constexpr std::uint32_t kNodeKeys =
+    std::max<std::uint32_t>(8, static_cast<std::uint32_t>(4 * kCacheLine / sizeof(Key)));
+
+ private:
+  struct alignas(kCacheLine) Node
+  {
+    Key keys[kNodeKeys];
+    std::uint32_t count = 0;
+  };
+  struct Inner : Node
+  {
+    Node *children[kNodeKeys + 1];
+  };
+  struct Leaf : Node
+  {
+    Leaf *prev = nullptr;
+    Leaf *next = nullptr;
+    T values[kNodeKeys];
+  };
+
+  /// @brief 使用 SIMD 查找的条件: 32 / 64 位整数 key, 默认的比较
+  static constexpr bool kSimdSearch = std::is_integral_v<Key> && !std::is_same_v<Key, bool> &&
+                                      (sizeof(Key) == 4 || sizeof(Key) == 8) &&
+                                      (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<Key>>);
+
+ public:
+  template <bool Const>
+  class basic_iterator
+  {
+    using mapped_ref = std::conditional_t<Const, const T &, T &>;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key &, mapped_ref>;
+
+    /// @brief operator-> 返回的代理对象, 使 it->first / it->second 可用
+    struct pointer
+    {
+      reference ref;
+      const reference *operator->() const noexcept
+      {
+        return &ref;
+      }
+    };
+
+    basic_iterator() = default;
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false> &other) noexcept :  // NOLINT
+      tree_(other.tree_), leaf_(other.leaf_), index_(other.index_)
+    {
+    }
+
+    reference operator*() const noexcept
+    {
+      return {leaf_->keys[index_], leaf_->values[index_]};
+    }
+    pointer operator->() const noexcept
+    {
+      return {**this};
+    }
+
+    basic_iterator &operator++() noexcept
+    {
+      if (++index_ == leaf_->count)
+      {
+        leaf_ = leaf_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept
+    {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+    basic_iterator &operator--() noexcept
+    {
+      if (leaf_ == nullptr)  // end()
+      {
+        leaf_ = tree_->last_;
+        index_ = leaf_->count - 1;
+      }
+      else if (index_ == 0)
+      {
+        leaf_ = leaf_->prev;
+        index_ = leaf_->count - 1;
+      }
+      else
+      {
+        --index_;
+      }
+      return *this;
+    }
+    basic_iterator operator--(int) noexcept
+    {
+      basic_iterator old = *this;
+      --*this;
+      return old;
+    }
+    friend bool operator==(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.leaf_ == b.leaf_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return !(a == b);
+    }
+
+   private:
+    friend class btree_map;
+    friend class basic_iterator<!Const>;
+
+    basic_iterator(const btree_map *tree, Leaf *leaf, std::uint32_t index) noexcept :
+      tree_(tree), leaf_(leaf), index_(index)
+    {
+    }
+
+    const btree_map *tree_ = nullptr;
+    Leaf *leaf_ = nullptr;  // nullptr 表示 end()
+    std::uint32_t index_ = 0;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  /// @brief [first, last) 范围, 可以直接用于 range-for, rbegin() / rend() 用于反向遍历
+  template <typename It>
+  struct range_view
+  {
+    It first;
+    It last;
+
+    It begin() const noexcept
+    {
+      return first;
+    }
+    It end() const noexcept
+    {
+      return last;
+    }
+    std::reverse_iterator<It> rbegin() const noexcept
+    {
+      return std::reverse_iterator<It>(last);
+    }
+    std::reverse_iterator<It> rend() const noexcept
+    {
+      return std::reverse_iterator<It>(first);
+    }
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return first == last;
+    }
+  };
+
+  btree_map() = default;
+
+  /// @brief 批量构建: 数据可以是乱序的(已经有序时跳过排序), 重复的 key 保留第一个
+  explicit btree_map(std::vector<std::pair<Key, T>> items, const Compare &comp = Compare()) : comp_(comp)
+  {
+    bulkLoad(items);
+  }
+
+  btree_map(std::initializer_list<std::pair<Key, T>> init) : btree_map(std::vector<std::pair<Key, T>>(init)) {}
+
+  btree_map(const btree_map &) = delete;
+  btree_map &operator=(const btree_map &) = delete;
+
+  btree_map(btree_map &&other) noexcept
+  {
+    swap(other);
+  }
+  btree_map &operator=(btree_map &&other) noexcept
+  {
+    btree_map(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~btree_map()
+  {
+    clear();
+  }
+
+  void swap(btree_map &other) noexcept
+  {
+    std::swap(root_, other.root_);
+    std::swap(first_, other.first_);
+    std::swap(last_, other.last_);
+    std::swap(size_, other.size_);
+    std::swap(height_, other.height_);
+    std::swap(comp_, other.comp_);
+  }
+
+  // ---------------- 迭代器 ----------------
+  iterator begin() noexcept
+  {
+    return {this, first_, 0};
+  }
+  iterator end() noexcept
+  {
+    return {this, nullptr, 0};
+  }
+  const_iterator begin() const noexcept
+  {
+    return {this, first_, 0};
+  }
+  const_iterator end() const noexcept
+  {
+    return {this, nullptr, 0};
+  }
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+  reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  // ---------------- 容量 ----------------
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_;
+  }
+  /// @brief 内部节点的层数, 只有一个叶子时为 0
+  [[nodiscard]] std::uint32_t height() const noexcept
+  {
+    return height_;
+  }
+
+  void clear() noexcept
+  {
+    if (root_ != nullptr) destroy(root_, height_);
+    root_ = nullptr;
+    first_ = last_ = nullptr;
+    size_ = 0;
+    height_ = 0;
+  }
+
+  // ---------------- 查找 ----------------
+  template <typename K>
+  iterator find(const K &key)
+  {
+    Leaf *leaf = findLeaf(key);
+    if (leaf == nullptr) return end();
+    const std::uint32_t i = rank<false>(leaf, key);
+    return i < leaf->count && !comp_(key, leaf->keys[i]) ? iterator{this, leaf, i} : end();
+  }
+  template <typename K>
+  const_iterator find(const K &key) const
+  {
+    return const_cast<btree_map *>(this)->find(key);
+  }
+  template <typename K>
+  [[nodiscard]] bool contains(const K &key) const
+  {
+    return find(key) != end();
+  }
+  template <typename K>
+  T &at(const K &key)
+  {
+    auto it = find(key);
+    if (it == end()) throw std::out_of_range("btree_map::at: key not found");
+    return it.leaf_->values[it.index_];
+  }
+  template <typename K>
+  const T &at(const K &key) const
+  {
+    return const_cast<btree_map *>(this)->at(key);
+  }
+
+  /// @brief 第一个不小于 key 的元素
+  template <typename K>
+  iterator lower_bound(const K &key)
+  {
+    return bound<false>(key);
+  }
+  template <typename K>
+  const_iterator lower_bound(const K &key) const
+  {
+    return const_cast<btree_map *>(this)->template bound<false>(key);
+  }
+  /// @brief 第一个大于 key 的元素
+  template <typename K>
+  iterator upper_bound(const K &key)
+  {
+    return bound<true>(key);
+  }
+  template <typename K>
+  const_iterator upper_bound(const K &key) const
+  {
+    return const_cast<btree_map *>(this)->template bound<true>(key);
+  }
+
+  /// @brief key 在 [lo, hi) 之内的全部元素; hi < lo 时返回空范围
+  template <typename K1, typename K2>
+  range_view<iterator> range(const K1 &lo, const K2 &hi)
+  {
+    if (comp_(hi, lo)) return {end(), end()};
+    return {lower_bound(lo), lower_bound(hi)};
+  }
+  template <typename K1, typename K2>
+  range_view<const_iterator> range(const K1 &lo, const K2 &hi) const
+  {
+    if (comp_(hi, lo)) return {end(), end()};
+    return {lower_bound(lo), lower_bound(hi)};
+  }
+
+  // ---------------- 插入 / 删除 ----------------
+  /// @brief 与 std::map::try_emplace 相同: key 已存在时什么也不做
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K &&key, Args &&...args)
+  {
+    return emplaceUnique<false>(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  /// @brief 与 std::map::insert_or_assign 相同
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign(K &&key, M &&obj)
+  {
+    return emplaceUnique<true>(std::forward<K>(key), std::forward<M>(obj));
+  }
+
+  std::pair<iterator, bool> insert(const std::pair<Key, T> &value)
+  {
+    return try_emplace(value.first, value.second);
+  }
+
+  template <typename K>
+  T &operator[](K &&key)
+  {
+    auto it = try_emplace(std::forward<K>(key)).first;
+    return it.leaf_->values[it.index_];
+  }
+
+  template <typename K>
+  size_type erase(const K &key)
+  {
+    if (root_ == nullptr) return 0;
+    bool emptied = false;
+    if (!eraseFrom(root_, height_, key, emptied)) return 0;
+    if (--size_ == 0)
+    {
+      clear();
+      return 1;
+    }
+    // 根节点只剩一个孩子时降低一层
+    while (height_ > 0 && root_->count == 0)
+    {
+      Inner *old = static_cast<Inner *>(root_);
+      root_ = old->children[0];
+      delete old;
+      --height_;
+    }
+    return 1;
+  }
+
+ private:
+  /// @brief 节点中小于 key(Upper 为 true 时是不大于 key)的 key 的个数
+  template <bool Upper, typename K>
+  std::uint32_t rank(const Node *node, const K &key) const
+  {
+    if constexpr (kSimdSearch && std::is_same_v<K, Key>)
+    {
+      return btree_detail::simdRank<Upper>(node->keys, node->count, key);
+    }
+    else
+    {
+      const Key *first = node->keys;
+      const Key *last = first + node->count;
+      if constexpr (Upper)
+        return static_cast<std::uint32_t>(std::upper_bound(first, last, key, comp_) - first);
+      else
+        return static_cast<std::uint32_t>(std::lower_bound(first, last, key, comp_) - first);
+    }
+  }
+
+  /// @brief 从根走到 key 所在的叶子. 分隔 key 是右侧子树的最小 key, 所以孩子的下标是不大于 key 的分隔 key 的个数
+  template <typename K>
+  Leaf *findLeaf(const K &key) const
+  {
+    Node *node = root_;
+    for (std::uint32_t level = height_; level > 0; --level)
+    {
+      const Inner *inner = static_cast<const Inner *>(node);
+      node = inner->children[rank<true>(inner, key)];
+    }
+    return static_cast<Leaf *>(node);
+  }
+
+  template <bool Upper, typename K>
+  iterator bound(const K &key)
+  {
+    Leaf *leaf = findLeaf(key);
+    if (leaf == nullptr) return end();
+    const std::uint32_t i = rank<Upper>(leaf, key);
+    // 叶子中所有 key 都更小时, 结果是下一个叶子的第一个元素
+    return i < leaf->count ? iterator{this, leaf, i} : iterator{this, leaf->next, 0};
+  }
+
+  /// @brief 子节点分裂时返回给父节点的信息: 新的右侧节点和它的最小 key
+  struct Split
+  {
+    Node *right = nullptr;
+    Key separator{};
+  };
+
+  /// @brief Assign 为 true 时 key 已存在则赋值(insert_or_assign), 为 false 时什么也不做(try_emplace)
+  template <bool Assign, typename K, typename... Args>
+  std::pair<iterator, bool> emplaceUnique(K &&key, Args &&...args)
+  {
+    if (root_ == nullptr)
+    {
+      first_ = last_ = new Leaf;
+      root_ = first_;
+    }
+    Split split;
+    auto result = insertInto<Assign>(root_, height_, split, std::forward<K>(key), std::forward<Args>(args)...);
+    if (split.right != nullptr)  // 根节点分裂, 树增高一层
+    {
+      Inner *root = new Inner;
+      root->keys[0] = std::move(split.separator);
+      root->children[0] = root_;
+      root->children[1] = split.right;
+      root->count = 1;
+      root_ = root;
+      ++height_;
+    }
+    return result;
+  }
+
+  template <bool Assign, typename K, typename... Args>
+  std::pair<iterator, bool> insertInto(Node *node, std::uint32_t level, Split &split, K &&key, Args &&...args)
+  {
+    if (level == 0)
+    {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      return insertIntoLeaf<Assign>(leaf, split, std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const std::uint32_t c = rank<true>(inner, key);
+    Split child;
+    auto result =
+      insertInto<Assign>(inner->children[c], level - 1, child, std::forward<K>(key), std::forward<Args>(args)...);
+    if (child.right == nullptr) return result;
+
+    // 孩子分裂了: 分隔 key 插入到第 c 个位置, 新孩子在它右边
+    if (inner->count < kNodeKeys)
+    {
+      insertChild(inner, c, std::move(child.separator), child.right);
+      return result;
+    }
+    // 本节点也满了: 中间的 key 上移到父节点, 右半部分移到新节点
+    constexpr std::uint32_t mid = kNodeKeys / 2;
+    Inner *right = new Inner;
+    right->count = kNodeKeys - mid - 1;
+    std::move(inner->keys + mid + 1, inner->keys + kNodeKeys, right->keys);
+    std::copy(inner->children + mid + 1, inner->children + kNodeKeys + 1, right->children);
+    split.separator = std::move(inner->keys[mid]);
+    split.right = right;
+    inner->count = mid;
+    // 新的分隔 key 介于 keys[c - 1] 和 keys[c] 之间, c <= mid 时一定小于上移的 key
+    if (c <= mid)
+      insertChild(inner, c, std::move(child.separator), child.right);
+    else
+      insertChild(right, c - mid - 1, std::move(child.separator), child.right);
+    return result;
+  }
+
+  static void insertChild(Inner *inner, std::uint32_t pos, Key &&separator, Node *child)
+  {
+    std::move_backward(inner->keys + pos, inner->keys + inner->count, inner->keys + inner->count + 1);
+    std::copy_backward(inner->children + pos + 1, inner->children + inner->count + 1,
+                       inner->children + inner->count + 2);
+    inner->keys[pos] = std::move(separator);
+    inner->children[pos + 1] = child;
+    ++inner->count;
+  }
+
+  template <bool Assign, typename K, typename... Args>
+  std::pair<iterator, bool> insertIntoLeaf(Leaf *leaf, Split &split, K &&key, Args &&...args)
+  {
+    std::uint32_t i = rank<false>(leaf, key);
+    if (i < leaf->count && !comp_(key, leaf->keys[i]))
+    {
+      if constexpr (Assign) leaf->values[i] = T(std::forward<Args>(args)...);
+      return {iterator{this, leaf, i}, false};
+    }
+    // 先构造 key 和 value, 构造抛出异常时树没有被修改
+    Key k(std::forward<K>(key));
+    T value(std::forward<Args>(args)...);
+    if (leaf->count == kNodeKeys)
+    {
+      Leaf *right = splitLeaf(leaf);
+      split.separator = right->keys[0];
+      split.right = right;
+      if (i > leaf->count)
+      {
+        i -= leaf->count;
+        leaf = right;
+      }
+    }
+    std::move_backward(leaf->keys + i, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+    std::move_backward(leaf->values + i, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+    leaf->keys[i] = std::move(k);
+    leaf->values[i] = std::move(value);
+    ++leaf->count;
+    ++size_;
+    return {iterator{this, leaf, i}, true};
+  }
+
+  /// @brief 右半部分移到新的叶子, 并链接到叶子链表中
+  Leaf *splitLeaf(Leaf *leaf)
+  {
+    constexpr std::uint32_t mid = kNodeKeys / 2;
+    Leaf *right = new Leaf;
+    right->count = kNodeKeys - mid;
+    std::move(leaf->keys + mid, leaf->keys + kNodeKeys, right->keys);
+    std::move(leaf->values + mid, leaf->values + kNodeKeys, right->values);
+    leaf->count = mid;
+    right->prev = leaf;
+    right->next = leaf->next;
+    (leaf->next != nullptr ? leaf->next->prev : last_) = right;
+    leaf->next = right;
+    return right;
+  }
+
+  /// @brief 删除 key, node 变空(已释放)时 emptied 为 true
+  template <typename K>
+  bool eraseFrom(Node *node, std::uint32_t level, const K &key, bool &emptied)
+  {
+    if (level == 0)
+    {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      const std::uint32_t i = rank<false>(leaf, key);
+      if (i == leaf->count || comp_(key, leaf->keys[i])) return false;
+      std::move(leaf->keys + i + 1, leaf->keys + leaf->count, leaf->keys + i);
+      std::move(leaf->values + i + 1, leaf->values + leaf->count, leaf->values + i);
+      if (--leaf->count == 0 && leaf != root_)
+      {
+        (leaf->prev != nullptr ? leaf->prev->next : first_) = leaf->next;
+        (leaf->next != nullptr ? leaf->next->prev : last_) = leaf->prev;
+        delete leaf;
+        emptied = true;
+      }
+      return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const std::uint32_t c = rank<true>(inner, key);
+    bool childEmptied = false;
+    if (!eraseFrom(inner->children[c], level - 1, key, childEmptied)) return false;
+    if (!childEmptied) return true;
+    if (inner->count == 0)  // 唯一的孩子被删除了
+    {
+      if (inner == root_)
+      {
+        root_ = nullptr;
+        height_ = 0;
+      }
+      delete inner;
+      emptied = true;
+      return true;
+    }
+    // 删除第 c 个孩子和它左边的分隔 key(c 为 0 时删除右边的)
+    const std::uint32_t k = c > 0 ? c - 1 : 0;
+    std::move(inner->keys + k + 1, inner->keys + inner->count, inner->keys + k);
+    std::copy(inner->children + c + 1, inner->children + inner->count + 1, inner->children + c);
+    --inner->count;
+    return true;
+  }
+
+  void bulkLoad(std::vector<std::pair<Key, T>> &items)
+  {
+    const auto less = [&](const auto &a, const auto &b) { return comp_(a.first, b.first); };
+    if (!std::is_sorted(items.begin(), items.end(), less)) std::stable_sort(items.begin(), items.end(), less);
+
+    // 叶子层: 依次填满每个叶子
+    std::vector<Node *> nodes;
+    std::vector<const Key *> mins;  // 每个节点的最小 key, 作为父节点中的分隔 key
+    Leaf *leaf = nullptr;
+    for (auto &item : items)
+    {
+      if (leaf != nullptr && !comp_(leaf->keys[leaf->count - 1], item.first)) continue;  // 与前一个 key 相等
+      if (leaf == nullptr || leaf->count == kNodeKeys)
+      {
+        Leaf *next = new Leaf;
+        next->prev = leaf;
+        (leaf != nullptr ? leaf->next : first_) = next;
+        leaf = last_ = next;
+        nodes.push_back(leaf);
+        mins.push_back(&leaf->keys[0]);
+      }
+      leaf->keys[leaf->count] = std::move(item.first);
+      leaf->values[leaf->count] = std::move(item.second);
+      ++leaf->count;
+      ++size_;
+    }
+
+    // 自底向上: 每 kNodeKeys + 1 个节点作为一个内部节点的孩子
+    while (nodes.size() > 1)
+    {
+      std::vector<Node *> parents;
+      std::vector<const Key *> parentMins;
+      for (std::size_t i = 0; i < nodes.size(); i += kNodeKeys + 1)
+      {
+        Inner *inner = new Inner;
+        inner->children[0] = nodes[i];
+        const std::size_t last = std::min<std::size_t>(i + kNodeKeys + 1, nodes.size());
+        for (std::size_t j = i + 1; j < last; ++j)
+        {
+          inner->keys[inner->count] = *mins[j];
+          inner->children[++inner->count] = nodes[j];
+        }
+        parents.push_back(inner);
+        parentMins.push_back(mins[i]);
+      }
+      nodes.swap(parents);
+      mins.swap(parentMins);
+      ++height_;
+    }
+    root_ = nodes.empty() ? nullptr : nodes[0];
+  }
+
+  static void destroy(Node *node, std::uint32_t level) noexcept
+  {
+    if (level == 0)
+    {
+      delete static_cast<Leaf *>(node);
+      return;
+    }
+    Inner *inner = static_cast<Inner *>(node);
+    for (std::uint32_t c = 0; c <= inner->count; ++c) destroy(inner->children[c], level - 1);
+    delete inner;
+  }
+
+  Node *root_ = nullptr;
+  Leaf *first_ = nullptr;
+  Leaf *last_ = nullptr;
+  size_type size_ = 0;
+  std::uint32_t height_ = 0;
+  Compare comp_;
+};
@@ -0,0 +1,621 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#else
+#define FLAT_HASH_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * Swiss table 风格的开放寻址哈希表(参考 absl::flat_hash_map).
+ *
+ * std::map / std::unordered_map 每个元素一个节点, 插入一次分配一次内存, 查找时沿着指针跳转;
+ * flat_hash_map 把所有元素放在一块连续内存中, 另外为每个槽位保存 1 个字节的控制字节:
+ *   - 空槽 kEmpty(0x80), 已删除 kDeleted(0xFE), 结束标记 kSentinel(0xFF), 三者的最高位都是 1;
+ *   - 有元素的槽位保存哈希值的低 7 位(H2), 最高位为 0.
+ * 槽位每 16 个一组, 查找时用 SSE2 一次比较一组控制字节(_mm_cmpeq_epi8 + _mm_movemask_epi8),
+ * 得到 H2 相同的槽位的位掩码, 只有这些槽位才需要真正比较 key. 组内没有命中且有空槽时, 查找结束.
+ * 哈希值的高位(H1)决定从哪一组开始, 之后按三角数序列(1, 3, 6, ...组)探测, 组数为 2 的幂时会遍历所有组.
+ * 非 x86 平台没有 SSE2, 用普通循环生成同样的位掩码.
+ *
+ * 与 std::unordered_map 的区别:
+ *   - 插入或扩容后迭代器和引用都会失效;
+ *   - value_type 是 std::pair<const Key, T>, 扩容时只能拷贝 key(const 成员不能移动), key 较大时先 reserve();
+ *   - Hash 和 KeyEqual 都带 is_transparent 时支持异构查找, 例如 flat_hash_map<std::string, int> 可以直接 find(string_view),
+ *     std::string 作为 key 时默认使用 string_hash, 不需要自己指定.
+ * 最大负载因子 7/8.
+ */
+
+/// @brief 支持异构查找的字符串哈希: std::string, std::string_view, const char * 的哈希值相同
+struct string_hash
+{
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view sv) const noexcept
+  {
+    return std::hash<std::string_view>{}(sv);
+  }
+};
+
+namespace flat_hash_detail
+{
+template <typename Key>
+struct default_hash
+{
+  using type = std::hash<Key>;
+};
+template <>
+struct default_hash<std::string>
+{
+  using type = string_hash;
+};
+
+using ctrl_t = std::int8_t;
+constexpr ctrl_t kEmpty = -128;   // 0x80
+constexpr ctrl_t kDeleted = -2;   // 0xFE
+constexpr ctrl_t kSentinel = -1;  // 0xFF
+constexpr std::size_t kGroupWidth = 16;
+
+inline unsigned countTrailingZeros(std::uint32_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward(&index, x);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+
+/// @brief 一组 16 个控制字节, match* 返回对应槽位的位掩码
+struct Group
+{
+#if FLAT_HASH_SSE2
+  explicit Group(const ctrl_t *p) noexcept : ctrl(_mm_load_si128(reinterpret_cast<const __m128i *>(p))) {}  // NOLINT
+
+  [[nodiscard]] std::uint32_t match(ctrl_t h2) const noexcept
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+  }
+  [[nodiscard]] std::uint32_t matchEmpty() const noexcept
+  {
+    return match(kEmpty);
+  }
+  /// @brief 空槽或已删除, 即小于 kSentinel 的字节
+  [[nodiscard]] std::uint32_t matchEmptyOrDeleted() const noexcept
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), ctrl)));
+  }
+
+  __m128i ctrl;
+#else
+  explicit Group(const ctrl_t *p) noexcept
+  {
+    std::memcpy(ctrl, p, kGroupWidth);
+  }
+
+  [[nodiscard]] std::uint32_t match(ctrl_t h2) const noexcept
+  {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < kGroupWidth; ++i) mask |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+    return mask;
+  }
+  [[nodiscard]] std::uint32_t matchEmpty() const noexcept
+  {
+    return match(kEmpty);
+  }
+  [[nodiscard]] std::uint32_t matchEmptyOrDeleted() const noexcept
+  {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < kGroupWidth; ++i) mask |= static_cast<std::uint32_t>(ctrl[i] < kSentinel) << i;
+    return mask;
+  }
+
+  ctrl_t ctrl[kGroupWidth];
+#endif
+};
+
+/// @brief 把哈希值的各个位打散: std::hash<int> 在 libstdc++ 中是恒等函数, 直接取低 7 位会有大量冲突
+inline std::size_t mix(std::size_t h) noexcept
+{
+  const std::uint64_t x = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<std::size_t>(x ^ (x >> 32));
+}
+}  // namespace flat_hash_detail
+
+template <typename Key, typename T, typename Hash = typename flat_hash_detail::default_hash<Key>::type,
+          typename KeyEqual = std::equal_to<>>
+class flat_hash_map
+{
+  using ctrl_t = flat_hash_detail::ctrl_t;
+  using Group = flat_hash_detail::Group;
+  static constexpr std::size_t kGroupWidth = flat_hash_detail::kGroupWidth;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  template <bool Const>
+  class basic_iterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = flat_hash_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type &, value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+    basic_iterator() = default;
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false> &other) noexcept : ctrl_(other.ctrl_), slot_(other.slot_)  // NOLINT
+    {
+    }
+
+    reference operator*() const noexcept
+    {
+      return *slot_;
+    }
+    pointer operator->() const noexcept
+    {
+      return slot_;
+    }
+    basic_iterator &operator++() noexcept
+    {
+      ++ctrl_;
+      ++slot_;
+      skipEmpty();
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept
+    {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+    friend bool operator==(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.slot_ == b.slot_;
+    }
+    friend bool operator!=(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.slot_ != b.slot_;
+    }
+
+   private:
+    friend class flat_hash_map;
+    friend class basic_iterator<!Const>;
+
+    basic_iterator(const ctrl_t *ctrl, pointer slot) noexcept : ctrl_(ctrl), slot_(slot) {}
+
+    void skipEmpty() noexcept
+    {
+      // 空槽和已删除都小于 kSentinel, 末尾的 kSentinel 保证循环会停下
+      while (*ctrl_ < flat_hash_detail::kSentinel)
+      {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    const ctrl_t *ctrl_ = nullptr;
+    pointer slot_ = nullptr;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  flat_hash_map() = default;
+
+  flat_hash_map(std::initializer_list<value_type> init)
+  {
+    reserve(init.size());
+    for (const value_type &v : init) try_emplace(v.first, v.second);
+  }
+
+  flat_hash_map(const flat_hash_map &other) : hash_(other.hash_), eq_(other.eq_)
+  {
+    reserve(other.size_);
+    for (const value_type &v : other) try_emplace(v.first, v.second);
+  }
+
+  flat_hash_map(flat_hash_map &&other) noexcept
+    : ctrl_(std::exchange(other.ctrl_, nullptr)),
+      slots_(std::exchange(other.slots_, nullptr)),
+      capacity_(std::exchange(other.capacity_, 0)),
+      size_(std::exchange(other.size_, 0)),
+      growth_left_(std::exchange(other.growth_left_, 0)),
+      hash_(std::move(other.hash_)),
+      eq_(std::move(other.eq_))
+  {
+  }
+
+  flat_hash_map &operator=(flat_hash_map other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~flat_hash_map()
+  {
+    destroyAll();
+    deallocate();
+  }
+
+  void swap(flat_hash_map &other) noexcept
+  {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_, other.hash_);
+    std::swap(eq_, other.eq_);
+  }
+
+  // ---------------- 迭代器 ----------------
+  iterator begin() noexcept
+  {
+    if (capacity_ == 0) return end();
+    iterator it(ctrl_, slots_);
+    it.skipEmpty();
+    return it;
+  }
+  iterator end() noexcept
+  {
+    return iterator(ctrl_ + capacity_, slots_ + capacity_);
+  }
+  const_iterator begin() const noexcept
+  {
+    return const_cast<flat_hash_map *>(this)->begin();
+  }
+  const_iterator end() const noexcept
+  {
+    return const_cast<flat_hash_map *>(this)->end();
+  }
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  // ---------------- 容量 ----------------
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_;
+  }
+  [[nodiscard]] size_type capacity() const noexcept
+  {
+    return capacity_;
+  }
+  [[nodiscard]] float load_factor() const noexcept
+  {
+    return capacity_ == 0 ? 0.0F : static_cast<float>(size_) / static_cast<float>(capacity_);
+  }
+
+  /// @brief 预留至少 n 个元素的空间, 之后插入 n 个元素不会扩容
+  void reserve(size_type n)
+  {
+    if (n > maxElements(capacity_)) rehash(capacityFor(n));
+  }
+
+  void clear() noexcept
+  {
+    destroyAll();
+    if (capacity_ != 0)
+    {
+      resetCtrl();
+      growth_left_ = maxElements(capacity_);
+    }
+    size_ = 0;
+  }
+
+  // ---------------- 查找 ----------------
+  template <typename K>
+  iterator find(const K &key)
+  {
+    const size_type i = findIndex(key);
+    return i == npos ? end() : iteratorAt(i);
+  }
+  template <typename K>
+  const_iterator find(const K &key) const
+  {
+    return const_cast<flat_hash_map *>(this)->find(key);
+  }
+  template <typename K>
+  [[nodiscard]] bool contains(const K &key) const
+  {
+    return findIndex(key) != npos;
+  }
+  template <typename K>
+  [[nodiscard]] size_type count(const K &key) const
+  {
+    return contains(key) ? 1 : 0;
+  }
+  template <typename K>
+  T &at(const K &key)
+  {
+    const size_type i = findIndex(key);
+    if (i == npos) throw std::out_of_range("flat_hash_map::at: key not found");
+    return slots_[i].second;
+  }
+  template <typename K>
+  const T &at(const K &key) const
+  {
+    return const_cast<flat_hash_map *>(this)->at(key);
+  }
+
+  // ---------------- 插入 ----------------
+  /// @brief 与 std::map::try_emplace 相同: key 已存在时什么也不做(也不会构造 value)
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K &&key, Args &&...args)
+  {
+    const auto [i, inserted, h2] = findOrPrepareInsert(key);
+    if (inserted)
+    {
+      ::new (static_cast<void *>(slots_ + i)) value_type(std::piecewise_construct,
+                                                         std::forward_as_tuple(std::forward<K>(key)),
+                                                         std::forward_as_tuple(std::forward<Args>(args)...));
+      commitInsert(i, h2);  // 构造成功之后再修改控制字节, 构造抛出异常时表保持不变
+    }
+    return {iteratorAt(i), inserted};
+  }
+
+  /// @brief 与 std::map::insert_or_assign 相同: key 不存在时插入, 存在时赋值, 返回值表示是否插入
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign(K &&key, M &&obj)
+  {
+    auto result = try_emplace(std::forward<K>(key), std::forward<M>(obj));
+    if (!result.second) result.first->second = std::forward<M>(obj);
+    return result;
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value)
+  {
+    return try_emplace(value.first, value.second);
+  }
+  std::pair<iterator, bool> insert(value_type &&value)
+  {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  template <typename K>
+  T &operator[](K &&key)
+  {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+
+  // ---------------- 删除 ----------------
+  template <typename K>
+  size_type erase(const K &key)
+  {
+    const size_type i = findIndex(key);
+    if (i == npos) return 0;
+    eraseAt(i);
+    return 1;
+  }
+
+  /// @brief 删除 pos 指向的元素, 返回下一个元素的迭代器(不会移动其他元素)
+  iterator erase(const_iterator pos)
+  {
+    const auto i = static_cast<size_type>(pos.slot_ - slots_);
+    eraseAt(i);
+    iterator next = iteratorAt(i);
+    next.skipEmpty();
+    return next;
+  }
+  iterator erase(iterator pos)
+  {
+    return erase(const_iterator(pos));
+  }
+
+ private:
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  static size_type maxElements(size_type capacity) noexcept
+  {
+    return capacity - capacity / 8;  // 负载因子 7/8
+  }
+
+  /// @brief 能容纳 n 个元素的最小容量: 2 的幂, 至少一组
+  static size_type capacityFor(size_type n) noexcept
+  {
+    size_type capacity = kGroupWidth;
+    while (maxElements(capacity) < n) capacity *= 2;
+    return capacity;
+  }
+
+  template <typename K>
+  size_type hashOf(const K &key) const
+  {
+    return flat_hash_detail::mix(hash_(key));
+  }
+
+  iterator iteratorAt(size_type i) noexcept
+  {
+    return iterator(ctrl_ + i, slots_ + i);
+  }
+
+  /// @brief 探测序列: 从 H1 对应的组开始, 第 k 次跳过 k 组
+  template <typename K>
+  size_type findIndex(const K &key) const
+  {
+    if (size_ == 0) return npos;
+    const size_type hash = hashOf(key);
+    const auto h2 = static_cast<ctrl_t>(hash & 0x7F);
+    const size_type group_mask = capacity_ / kGroupWidth - 1;
+    size_type group = (hash >> 7) & group_mask;
+    for (size_type step = 1;; ++step)
+    {
+      const size_type base = group * kGroupWidth;
+      const Group g(ctrl_ + base);
+      for (std::uint32_t mask = g.match(h2); mask != 0; mask &= mask - 1)
+      {
+        const size_type i = base + flat_hash_detail::countTrailingZeros(mask);
+        if (eq_(slots_[i].first, key)) return i;
+      }
+      if (g.matchEmpty() != 0) return npos;
+      group = (group + step) & group_mask;
+    }
+  }
+
+  /// @brief 探测序列上第一个空槽或已删除的槽位
+  size_type findFirstNonFull(size_type hash) const noexcept
+  {
+    const size_type group_mask = capacity_ / kGroupWidth - 1;
+    size_type group = (hash >> 7) & group_mask;
+    for (size_type step = 1;; ++step)
+    {
+      const size_type base = group * kGroupWidth;
+      if (const std::uint32_t mask = Group(ctrl_ + base).matchEmptyOrDeleted(); mask != 0)
+        return base + flat_hash_detail::countTrailingZeros(mask);
+      group = (group + step) & group_mask;
+    }
+  }
+
+  struct InsertPosition
+  {
+    size_type index;
+    bool inserted;
+    ctrl_t h2;
+  };
+
+  /// @brief 返回 key 所在的槽位, 或者为 key 预留的槽位(此时 inserted 为 true, 槽位中还没有构造元素)
+  template <typename K>
+  InsertPosition findOrPrepareInsert(const K &key)
+  {
+    if (const size_type i = findIndex(key); i != npos) return {i, false, 0};
+    if (capacity_ == 0) rehash(kGroupWidth);
+    const size_type hash = hashOf(key);
+    size_type i = findFirstNonFull(hash);
+    if (growth_left_ == 0 && ctrl_[i] != flat_hash_detail::kDeleted)
+    {
+      // 已删除的槽位较多时原地整理, 否则容量翻倍
+      rehash(size_ < maxElements(capacity_) / 2 ? capacity_ : capacity_ * 2);
+      i = findFirstNonFull(hash);
+    }
+    return {i, true, static_cast<ctrl_t>(hash & 0x7F)};
+  }
+
+  void commitInsert(size_type i, ctrl_t h2) noexcept
+  {
+    if (ctrl_[i] == flat_hash_detail::kEmpty) --growth_left_;
+    ctrl_[i] = h2;
+    ++size_;
+  }
+
+  void eraseAt(size_type i)
+  {
+    slots_[i].~value_type();
+    --size_;
+    // 探测在遇到含有空槽的组时停止; 所在组本来就有空槽的话, 直接标记为空槽不会打断其他 key 的探测序列
+    const size_type base = i / kGroupWidth * kGroupWidth;
+    if (Group(ctrl_ + base).matchEmpty() != 0)
+    {
+      ctrl_[i] = flat_hash_detail::kEmpty;
+      ++growth_left_;
+    }
+    else
+    {
+      ctrl_[i] = flat_hash_detail::kDeleted;
+    }
+  }
+
+  void rehash(size_type new_capacity)
+  {
+    ctrl_t *old_ctrl = ctrl_;
+    value_type *old_slots = slots_;
+    const size_type old_capacity = capacity_;
+    allocate(new_capacity);
+    for (size_type i = 0; i < old_capacity; ++i)
+    {
+      if (old_ctrl[i] < 0) continue;
+      const size_type hash = hashOf(old_slots[i].first);
+      const size_type j = findFirstNonFull(hash);
+      ctrl_[j] = static_cast<ctrl_t>(hash & 0x7F);
+      // key 是 const 的, 只能拷贝; value 可以移动
+      ::new (static_cast<void *>(slots_ + j)) value_type(old_slots[i].first, std::move(old_slots[i].second));
+      old_slots[i].~value_type();
+    }
+    growth_left_ = maxElements(capacity_) - size_;
+    if (old_capacity != 0) ::operator delete(old_ctrl, std::align_val_t{kAlignment});
+  }
+
+  static constexpr std::size_t kAlignment = alignof(value_type) > kGroupWidth ? alignof(value_type) : kGroupWidth;
+
+  /// @brief 控制字节和槽位放在同一块内存中: [capacity 个控制字节][kSentinel][补齐][capacity 个槽位]
+  static size_type ctrlBytes(size_type capacity) noexcept
+  {
+    return (capacity + 1 + kAlignment - 1) / kAlignment * kAlignment;
+  }
+
+  void allocate(size_type capacity)
+  {
+    void *memory =
+      ::operator new(ctrlBytes(capacity) + capacity * sizeof(value_type), std::align_val_t{kAlignment});
+    ctrl_ = static_cast<ctrl_t *>(memory);
+    slots_ = reinterpret_cast<value_type *>(static_cast<char *>(memory) + ctrlBytes(capacity));  // NOLINT
+    capacity_ = capacity;
+    resetCtrl();
+    growth_left_ = maxElements(capacity);
+  }
+
+  void resetCtrl() noexcept
+  {
+    std::memset(ctrl_, static_cast<unsigned char>(flat_hash_detail::kEmpty), capacity_);
+    ctrl_[capacity_] = flat_hash_detail::kSentinel;
+  }
+
+  void destroyAll() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    {
+      for (size_type i = 0; i < capacity_; ++i)
+        if (ctrl_[i] >= 0) slots_[i].~value_type();
+    }
+  }
+
+  void deallocate() noexcept
+  {
+    if (capacity_ != 0) ::operator delete(ctrl_, std::align_val_t{kAlignment});
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+  }
+
+  ctrl_t *ctrl_ = nullptr;
+  value_type *slots_ = nullptr;
+  size_type capacity_ = 0;
+  size_type size_ = 0;
+  size_type growth_left_ = 0;
+  Hash hash_;
+  KeyEqual eq_;
+};
@@ -0,0 +1,411 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * 有序的 flat_map: key 和 value 分别按 key 的顺序保存在两个 std::vector 中(接口参考 C++23 std::flat_map).
+ *
+ * std::map 是红黑树, 查找时每一层都要沿着指针访问一个新的节点, 节点分散在堆上, 几乎每一步都是缓存未命中;
+ * flat_map 在连续的 key 数组上二分查找, 遍历就是顺序读两个数组, 适合 "构建一次, 查找很多次" 的场景.
+ *   - 二分查找是无分支的: 循环次数只取决于元素个数, 每一步用条件传送(cmov)选择下一半, 没有分支预测失败;
+ *   - 批量构建: 从未排序的数据构造时只排序一次, O(n log n), 重复的 key 保留第一个(与 std::map 的区间插入相同);
+ *   - 单个插入 / 删除需要移动后面的元素, O(n), 插入很多元素时应该先收集起来再批量构建.
+ * 解引用迭代器得到 std::pair<const Key &, T &>(临时对象), 所以结构化绑定要写成 const auto &[key, value] 或 auto [key, value].
+ * 迭代器支持随机访问迭代器的全部运算(与 std::vector<bool> 一样 reference 是代理对象), 可以用于 std::lower_bound,
+ * std::distance 等只读算法; 需要交换元素的算法(例如 std::sort)不适用, 也不需要: 元素总是有序的.
+ * 插入和删除会使迭代器失效.
+ */
+
+/// @brief 构造函数的标记: 传入的数据已经按 key 排序且没有重复
+struct sorted_unique_t
+{
+  explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+template <typename Key, typename T, typename Compare = std::less<>>
+class flat_map
+{
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+
+  template <bool Const>
+  class basic_iterator
+  {
+    using mapped_ref = std::conditional_t<Const, const T &, T &>;
+
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key &, mapped_ref>;
+
+    /// @brief operator-> 返回的代理对象, 使 it->first / it->second 可用
+    struct pointer
+    {
+      reference ref;
+      const reference *operator->() const noexcept
+      {
+        return &ref;
+      }
+    };
+
+    basic_iterator() = default;
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false> &other) noexcept : map_(other.map_), index_(other.index_)  // NOLINT
+    {
+    }
+
+    reference operator*() const noexcept
+    {
+      return {map_->keys_[index_], map_->values_[index_]};
+    }
+    pointer operator->() const noexcept
+    {
+      return {**this};
+    }
+    reference operator[](difference_type n) const noexcept
+    {
+      return *(*this + n);
+    }
+
+    basic_iterator &operator++() noexcept
+    {
+      ++index_;
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept
+    {
+      basic_iterator old = *this;
+      ++index_;
+      return old;
+    }
+    basic_iterator &operator--() noexcept
+    {
+      --index_;
+      return *this;
+    }
+    basic_iterator operator--(int) noexcept
+    {
+      basic_iterator old = *this;
+      --index_;
+      return old;
+    }
+    basic_iterator &operator+=(difference_type n) noexcept
+    {
+      index_ = static_cast<size_type>(static_cast<difference_type>(index_) + n);
+      return *this;
+    }
+    basic_iterator &operator-=(difference_type n) noexcept
+    {
+      return *this += -n;
+    }
+    friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept
+    {
+      return it += n;
+    }
+    friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept
+    {
+      return it += n;
+    }
+    friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept
+    {
+      return it -= n;
+    }
+    friend difference_type operator-(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+    friend bool operator==(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ != b.index_;
+    }
+    friend bool operator<(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ < b.index_;
+    }
+    friend bool operator>(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ > b.index_;
+    }
+    friend bool operator<=(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ <= b.index_;
+    }
+    friend bool operator>=(const basic_iterator &a, const basic_iterator &b) noexcept
+    {
+      return a.index_ >= b.index_;
+    }
+
+   private:
+    friend class flat_map;
+    friend class basic_iterator<!Const>;
+    using map_pointer = std::conditional_t<Const, const flat_map *, flat_map *>;
+
+    basic_iterator(map_pointer map, size_type index) noexcept : map_(map), index_(index) {}
+
+    map_pointer map_ = nullptr;
+    size_type index_ = 0;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  flat_map() = default;
+
+  /// @brief 批量构建: 数据可以是乱序的, 重复的 key 保留第一个
+  explicit flat_map(std::vector<std::pair<Key, T>> items, const Compare &comp = Compare()) : comp_(comp)
+  {
+    std::stable_sort(items.begin(), items.end(),
+                     [&](const auto &a, const auto &b) { return comp_(a.first, b.first); });
+    keys_.reserve(items.size());
+    values_.reserve(items.size());
+    for (auto &item : items)
+    {
+      if (!keys_.empty() && !comp_(keys_.back(), item.first)) continue;  // 与前一个 key 相等
+      keys_.push_back(std::move(item.first));
+      values_.push_back(std::move(item.second));
+    }
+  }
+
+  flat_map(std::initializer_list<std::pair<Key, T>> init) : flat_map(std::vector<std::pair<Key, T>>(init)) {}
+
+  /// @brief 直接接管已经排好序且没有重复的 key / value 数组
+  flat_map(sorted_unique_t, std::vector<Key> keys, std::vector<T> values, const Compare &comp = Compare()) :
+    keys_(std::move(keys)), values_(std::move(values)), comp_(comp)
+  {
+  }
+
+  // ---------------- 迭代器 ----------------
+  iterator begin() noexcept
+  {
+    return {this, 0};
+  }
+  iterator end() noexcept
+  {
+    return {this, keys_.size()};
+  }
+  const_iterator begin() const noexcept
+  {
+    return {this, 0};
+  }
+  const_iterator end() const noexcept
+  {
+    return {this, keys_.size()};
+  }
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+  reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  // ---------------- 容量 ----------------
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+  void reserve(size_type n)
+  {
+    keys_.reserve(n);
+    values_.reserve(n);
+  }
+  void clear() noexcept
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  /// @brief 按顺序排列的全部 key / value, 可以直接交给需要连续数组的代码
+  [[nodiscard]] const std::vector<Key> &keys() const noexcept
+  {
+    return keys_;
+  }
+  [[nodiscard]] const std::vector<T> &values() const noexcept
+  {
+    return values_;
+  }
+
+  // ---------------- 查找 ----------------
+  /// @brief 第一个不小于 key 的位置
+  template <typename K>
+  [[nodiscard]] size_type lower_bound_index(const K &key) const
+  {
+    const Key *base = keys_.data();
+    size_type n = keys_.size();
+    if (n == 0) return 0;
+    // 答案始终在 [base, base + n] 之内, 每次排除一半; 三元运算符会被编译成 cmov, 没有分支
+    while (n > 1)
+    {
+      const size_type half = n / 2;
+      base = comp_(base[half], key) ? base + half : base;
+      n -= half;
+    }
+    return static_cast<size_type>(base - keys_.data()) + (comp_(*base, key) ? 1 : 0);
+  }
+
+  template <typename K>
+  iterator lower_bound(const K &key)
+  {
+    return {this, lower_bound_index(key)};
+  }
+  template <typename K>
+  const_iterator lower_bound(const K &key) const
+  {
+    return {this, lower_bound_index(key)};
+  }
+  template <typename K>
+  iterator upper_bound(const K &key)
+  {
+    size_type i = lower_bound_index(key);
+    if (i < keys_.size() && !comp_(key, keys_[i])) ++i;  // key 唯一, 最多跳过一个
+    return {this, i};
+  }
+  template <typename K>
+  iterator find(const K &key)
+  {
+    const size_type i = lower_bound_index(key);
+    return i < keys_.size() && !comp_(key, keys_[i]) ? iterator{this, i} : end();
+  }
+  template <typename K>
+  const_iterator find(const K &key) const
+  {
+    const size_type i = lower_bound_index(key);
+    return i < keys_.size() && !comp_(key, keys_[i]) ? const_iterator{this, i} : end();
+  }
+  template <typename K>
+  [[nodiscard]] bool contains(const K &key) const
+  {
+    return find(key) != end();
+  }
+  template <typename K>
+  [[nodiscard]] size_type count(const K &key) const
+  {
+    return contains(key) ? 1 : 0;
+  }
+  template <typename K>
+  T &at(const K &key)
+  {
+    auto it = find(key);
+    if (it == end()) throw std::out_of_range("flat_map::at: key not found");
+    return values_[it.index_];
+  }
+  template <typename K>
+  const T &at(const K &key) const
+  {
+    return const_cast<flat_map *>(this)->at(key);
+  }
+
+  // ---------------- 插入 / 删除 ----------------
+  /// @brief 与 std::map::try_emplace 相同: key 已存在时什么也不做
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K &&key, Args &&...args)
+  {
+    const size_type i = lower_bound_index(key);
+    if (i < keys_.size() && !comp_(key, keys_[i])) return {iterator{this, i}, false};
+    return {emplaceAt(i, std::forward<K>(key), std::forward<Args>(args)...), true};
+  }
+
+  /// @brief 与 std::map::insert_or_assign 相同
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign(K &&key, M &&obj)
+  {
+    const size_type i = lower_bound_index(key);
+    if (i < keys_.size() && !comp_(key, keys_[i]))
+    {
+      values_[i] = std::forward<M>(obj);
+      return {iterator{this, i}, false};
+    }
+    return {emplaceAt(i, std::forward<K>(key), std::forward<M>(obj)), true};
+  }
+
+  std::pair<iterator, bool> insert(const std::pair<Key, T> &value)
+  {
+    return try_emplace(value.first, value.second);
+  }
+
+  template <typename K>
+  T &operator[](K &&key)
+  {
+    return values_[try_emplace(std::forward<K>(key)).first.index_];
+  }
+
+  template <typename K>
+  size_type erase(const K &key)
+  {
+    auto it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    const auto offset = static_cast<std::ptrdiff_t>(pos.index_);
+    keys_.erase(keys_.begin() + offset);
+    values_.erase(values_.begin() + offset);
+    return {this, pos.index_};
+  }
+  iterator erase(iterator pos)
+  {
+    return erase(const_iterator(pos));
+  }
+
+ private:
+  template <typename K, typename... Args>
+  iterator emplaceAt(size_type i, K &&key, Args &&...args)
+  {
+    keys_.emplace(keys_.begin() + static_cast<std::ptrdiff_t>(i), std::forward<K>(key));
+    try
+    {
+      values_.emplace(values_.begin() + static_cast<std::ptrdiff_t>(i), std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      keys_.erase(keys_.begin() + static_cast<std::ptrdiff_t>(i));  // 保持两个数组长度一致
+      throw;
+    }
+    return {this, i};
+  }
+
+  std::vector<Key> keys_;
+  std::vector<T> values_;
+  Compare comp_;
+};
@@ -1,5 +1,641 @@
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <list>
 #include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "bench.hpp"
+#include "btree_map.hpp"
+#include "flat_hash_map.hpp"
+#include "flat_map.hpp"
+#include "node_pool_allocator.hpp"
+
+/// @brief flat_hash_map 的用法与 std::map 相同(insert_or_assign / try_emplace / 结构化绑定), 只是遍历顺序不固定
+void testFlatHashMap()
+{
+  flat_hash_map<int, std::string> hashMap{{1, "one"}, {2, "two"}, {3, "three"}};
+  hashMap[4] = "four";
+  // 插入可能触发扩容, 之前的迭代器会失效, 所以每次只使用刚刚返回的迭代器
+  auto [iter1, inserted1] = hashMap.insert_or_assign(5, "five");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted1, iter1->first, iter1->second);
+  auto [iter2, inserted2] = hashMap.insert_or_assign(5, "five2");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted2, iter2->first, iter2->second);
+  auto [iter3, inserted3] = hashMap.try_emplace(5, "not used");  // key 已存在, 不会构造 value
+  fmt::println("try_emplace Inserted: {}, Key: {}, Value: {}", inserted3, iter3->first, iter3->second);
+  for (const auto &[key, value] : hashMap) fmt::println("Key: {}, Value: {}", key, value);
+
+  // std::string 作为 key 时可以直接用 string_view / const char * 查找, 不构造临时的 std::string
+  flat_hash_map<std::string, int> counts{{"apple", 5}, {"banana", 3}};
+  std::string_view banana = "banana split";
+  fmt::println("counts.find(\"{}\") -> {}", banana.substr(0, 6), counts.find(banana.substr(0, 6))->second);
+
+  // 随机插入 / 删除, 与 std::unordered_map 对比
+  flat_hash_map<std::uint32_t, std::uint32_t> flat;
+  std::unordered_map<std::uint32_t, std::uint32_t> reference;
+  std::mt19937 rng(1);
+  std::size_t errors = 0;
+  for (int i = 0; i < 200000; ++i)
+  {
+    const std::uint32_t key = rng() % 5000;
+    switch (rng() % 3)
+    {
+      case 0:
+        flat.insert_or_assign(key, static_cast<std::uint32_t>(i));
+        reference.insert_or_assign(key, static_cast<std::uint32_t>(i));
+        break;
+      case 1:
+        errors += flat.erase(key) != reference.erase(key) ? 1 : 0;
+        break;
+      default:
+      {
+        auto it = flat.find(key);
+        auto ref = reference.find(key);
+        errors += (it == flat.end()) != (ref == reference.end()) || (it != flat.end() && it->second != ref->second);
+      }
+    }
+  }
+  std::size_t visited = 0;
+  for (const auto &[key, value] : flat) visited += reference.at(key) == value ? 1 : 0;
+  errors += visited != reference.size() || flat.size() != reference.size() ? 1 : 0;
+  fmt::println("flat_hash_map vs std::unordered_map: {} errors", errors);
+}
+
+/// @brief 插入 / 命中查找 / 未命中查找 / 遍历, 元素个数从 1K 到 MAP_BENCH_MAX_KEYS(默认 100 万), 每次乘以 10.
+/// 设置为 100000000 可以测试 1 亿个 key, 此时 std::map 需要 5GB 以上的内存
+void benchFlatHashMap()
+{
+  std::size_t max_keys = 1'000'000;
+  if (const char *env = std::getenv("MAP_BENCH_MAX_KEYS")) max_keys = std::strtoull(env, nullptr, 10);
+
+  fmt::println("========== benchmark: std::map vs std::unordered_map vs flat_hash_map (uint64 -> uint64) ==========");
+  fmt::println("  {:>10} {:<24} {:>10} {:>10} {:>10} {:>10}   (ns/op)", "keys", "container", "insert", "find hit",
+               "find miss", "iterate");
+  for (std::size_t n = 1000; n <= max_keys; n *= 10)
+  {
+    std::mt19937_64 rng(n);
+    std::vector<std::uint64_t> keys(n);
+    std::vector<std::uint64_t> misses(n);
+    for (auto &k : keys) k = rng() | 1;  // 奇数是命中的 key, 偶数一定不存在
+    for (auto &k : misses) k = rng() & ~std::uint64_t{1};
+    std::vector<std::uint64_t> queries = keys;
+    std::shuffle(queries.begin(), queries.end(), rng);
+    const std::size_t rounds = std::max<std::size_t>(1, 1'000'000 / n);  // 小规模时多跑几轮
+
+    auto run = [&](const char *name, auto make)
+    {
+      double insert = 0;
+      double hit = 0;
+      double miss = 0;
+      double iterate = 0;
+      for (std::size_t r = 0; r < rounds; ++r)
+      {
+        auto map = make();
+        insert += bench::nsPerOp(n, [&] { for (std::uint64_t k : keys) map.insert_or_assign(k, k); });
+        hit += bench::nsPerOp(n, [&] { for (std::uint64_t k : queries) bench::doNotOptimize(map.find(k)->second); });
+        miss += bench::nsPerOp(n, [&] { for (std::uint64_t k : misses) bench::doNotOptimize(map.count(k)); });
+        iterate += bench::nsPerOp(n, [&]
+                                  {
+                                    std::uint64_t sum = 0;
+                                    for (const auto &[key, value] : map) sum += value;
+                                    bench::doNotOptimize(sum);
+                                  });
+      }
+      const auto avg = [&](double total) { return total / static_cast<double>(rounds); };
+      fmt::println("  {:>10} {:<24} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.2f}", n, name, avg(insert), avg(hit), avg(miss),
+                   avg(iterate));
+    };
+    run("std::map", [] { return std::map<std::uint64_t, std::uint64_t>(); });
+    run("std::unordered_map", [] { return std::unordered_map<std::uint64_t, std::uint64_t>(); });
+    run("flat_hash_map", [] { return flat_hash_map<std::uint64_t, std::uint64_t>(); });
+  }
+
+  // 字符串 key: 从 string_view 查找
+  constexpr std::size_t kStrings = 100'000;
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < kStrings; ++i) names.push_back("customer/" + std::to_string(i * 7919) + "/orders");
+  std::vector<std::string_view> views(names.begin(), names.end());
+  std::shuffle(views.begin(), views.end(), std::mt19937(5));
+  std::unordered_map<std::string, std::size_t> stdMap;
+  flat_hash_map<std::string, std::size_t> flatMap;
+  for (std::size_t i = 0; i < kStrings; ++i)
+  {
+    stdMap.try_emplace(names[i], i);
+    flatMap.try_emplace(names[i], i);
+  }
+  fmt::println("========== benchmark: {} string keys, lookup by string_view ==========", kStrings);
+  auto lookup = [&](const char *name, auto &&find)
+  {
+    bench::report(name, bench::nsPerOp(kStrings, [&]
+                                       {
+                                         for (std::string_view sv : views) bench::doNotOptimize(find(sv));
+                                       }));
+  };
+  lookup("unordered_map::find(std::string(sv))",
+         [&](std::string_view sv) { return stdMap.find(std::string(sv))->second; });
+  lookup("flat_hash_map::find(sv)", [&](std::string_view sv) { return flatMap.find(sv)->second; });
+}
+
+/// @brief flat_map 的用法与 std::map 相同, 遍历时同样按 key 排序
+void testFlatMap()
+{
+  flat_map<int, std::string> flatMap{{3, "three"}, {1, "one"}, {2, "two"}, {1, "duplicate"}};  // 重复的 key 保留第一个
+  flatMap[4] = "four";
+  auto [iter1, inserted1] = flatMap.insert_or_assign(5, "five");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted1, iter1->first, iter1->second);
+  auto [iter2, inserted2] = flatMap.insert_or_assign(5, "five2");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted2, iter2->first, iter2->second);
+  for (const auto &[key, value] : flatMap) fmt::println("Key: {}, Value: {}", key, value);
+  fmt::println("lower_bound(3) -> {}, upper_bound(3) -> {}", flatMap.lower_bound(3)->first,
+               flatMap.upper_bound(3)->first);
+
+  // 随机数据批量构建, 与 std::map 对比查找和遍历的结果
+  std::mt19937 rng(2);
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> items;
+  std::map<std::uint32_t, std::uint32_t> reference;
+  for (std::uint32_t i = 0; i < 100000; ++i)
+  {
+    items.emplace_back(rng() % 50000, i);
+    reference.insert(items.back());
+  }
+  flat_map<std::uint32_t, std::uint32_t> bulk(items);
+  std::size_t errors = bulk.size() != reference.size() ? 1 : 0;
+  auto ref = reference.begin();
+  for (const auto &[key, value] : bulk) errors += key != ref->first || value != (ref++)->second ? 1 : 0;
+  for (std::uint32_t k = 0; k < 50001; ++k)
+  {
+    errors += bulk.count(k) != reference.count(k) ? 1 : 0;
+    auto lb = bulk.lower_bound(k);
+    auto rlb = reference.lower_bound(k);
+    errors += (lb == bulk.end()) != (rlb == reference.end()) || (rlb != reference.end() && lb->first != rlb->first);
+  }
+
+  // 随机访问迭代器: 标准算法按 iterator_category 选择实现, 需要全部的比较和算术运算
+  auto mid = 2 + bulk.begin() + static_cast<std::ptrdiff_t>(bulk.size() / 2);
+  auto byKey = [](const auto &entry, std::uint32_t k) { return entry.first < k; };
+  errors += std::distance(bulk.begin(), bulk.end()) != static_cast<std::ptrdiff_t>(bulk.size()) ? 1 : 0;
+  errors += std::lower_bound(bulk.begin(), bulk.end(), mid->first, byKey) != mid ? 1 : 0;
+  errors += !(bulk.begin() < mid && mid > bulk.begin() && mid <= mid && mid >= bulk.cbegin()) ? 1 : 0;
+  errors += std::prev(mid, 2)[2].first != mid->first || !(bulk.rbegin() < bulk.rend()) ? 1 : 0;
+  fmt::println("flat_map vs std::map: {} errors", errors);
+}
+
+/// @brief 构建 / 命中查找 / 遍历: std::map vs flat_map(分支二分查找 std::lower_bound 和无分支二分查找)
+void benchFlatMap()
+{
+  std::size_t max_keys = 1'000'000;
+  if (const char *env = std::getenv("MAP_BENCH_MAX_KEYS")) max_keys = std::strtoull(env, nullptr, 10);
+
+  fmt::println("========== benchmark: std::map vs flat_map (uint64 -> uint64) ==========");
+  fmt::println("  {:>10} {:<32} {:>10} {:>10} {:>10}   (ns/op)", "keys", "container", "build", "find hit", "iterate");
+  for (std::size_t n = 1000; n <= max_keys; n *= 10)
+  {
+    std::mt19937_64 rng(n);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> items(n);
+    for (auto &[key, value] : items) key = value = rng();
+    std::vector<std::uint64_t> queries(n);
+    for (auto &q : queries) q = items[rng() % n].first;
+    const std::size_t rounds = std::max<std::size_t>(1, 1'000'000 / n);
+    const auto row = [&](const char *name, double build, double hit, double iterate)
+    {
+      const auto r = static_cast<double>(rounds);
+      fmt::println("  {:>10} {:<32} {:>10.1f} {:>10.1f} {:>10.2f}", n, name, build / r, hit / r, iterate / r);
+    };
+
+    double build = 0, hit = 0, iterate = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+      std::map<std::uint64_t, std::uint64_t> map;
+      build += bench::nsPerOp(n, [&] { for (const auto &[key, value] : items) map.insert_or_assign(key, value); });
+      hit += bench::nsPerOp(n, [&] { for (std::uint64_t q : queries) bench::doNotOptimize(map.find(q)->second); });
+      iterate += bench::nsPerOp(n, [&]
+                                {
+                                  std::uint64_t sum = 0;
+                                  for (const auto &[key, value] : map) sum += value;
+                                  bench::doNotOptimize(sum);
+                                });
+    }
+    row("std::map", build, hit, iterate);
+
+    build = hit = iterate = 0;
+    double branchy = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+      flat_map<std::uint64_t, std::uint64_t> map;
+      build += bench::nsPerOp(n, [&] { map = flat_map<std::uint64_t, std::uint64_t>(items); });
+      hit += bench::nsPerOp(n, [&] { for (std::uint64_t q : queries) bench::doNotOptimize(map.find(q)->second); });
+      iterate += bench::nsPerOp(n, [&]
+                                {
+                                  std::uint64_t sum = 0;
+                                  for (const auto &[key, value] : map) sum += value;
+                                  bench::doNotOptimize(sum);
+                                });
+      const auto &keys = map.keys();
+      branchy += bench::nsPerOp(n, [&]
+                                {
+                                  for (std::uint64_t q : queries)
+                                    bench::doNotOptimize(std::lower_bound(keys.begin(), keys.end(), q));
+                                });
+    }
+    row("flat_map (bulk build)", build, hit, iterate);
+    fmt::println("  {:>10} {:<32} {:>10} {:>10.1f} {:>10}", n, "  std::lower_bound on keys()", "-",
+                 branchy / static_cast<double>(rounds), "-");
+  }
+}
+
+/// @brief 随机插入 / 删除 / 查找, 每一步都与 std::map 对比, 最后比较正向 / 反向遍历和范围查询的结果
+template <typename Key, typename MakeKey>
+std::size_t checkBTreeMap(MakeKey makeKey, int ops)
+{
+  btree_map<Key, int> tree;
+  std::map<Key, int> reference;
+  std::mt19937 rng(3);
+  std::size_t errors = 0;
+  const auto same = [&](auto it, auto ref)
+  { return (it == tree.end()) == (ref == reference.end()) && (ref == reference.end() || it->first == ref->first); };
+  const auto compareAll = [&]
+  {
+    errors += tree.size() != reference.size() ? 1 : 0;
+    auto ref = reference.begin();
+    for (const auto &[key, value] : tree) errors += key != ref->first || value != (ref++)->second ? 1 : 0;
+    auto rref = reference.rbegin();
+    for (auto it = tree.rbegin(); it != tree.rend(); ++it) errors += (*it).first != (rref++)->first ? 1 : 0;
+  };
+  for (int i = 0; i < ops; ++i)
+  {
+    const Key key = makeKey(rng);
+    switch (rng() % 6)
+    {
+      case 0:
+      case 1:
+        errors += tree.insert_or_assign(key, i).second != reference.insert_or_assign(key, i).second ? 1 : 0;
+        break;
+      case 2:
+        errors += tree.try_emplace(key, i).second != reference.try_emplace(key, i).second ? 1 : 0;
+        break;
+      case 3:
+        errors += tree.erase(key) != reference.erase(key) ? 1 : 0;
+        break;
+      case 4:
+        errors += same(tree.lower_bound(key), reference.lower_bound(key)) ? 0 : 1;
+        errors += same(tree.upper_bound(key), reference.upper_bound(key)) ? 0 : 1;
+        break;
+      default:
+      {
+        auto it = tree.find(key);
+        auto ref = reference.find(key);
+        errors += same(it, ref) && (ref == reference.end() || it->second == ref->second) ? 0 : 1;
+      }
+    }
+  }
+  compareAll();
+
+  // 范围查询: [lo, hi) 正向和反向
+  for (int i = 0; i < 100; ++i)
+  {
+    Key lo = makeKey(rng), hi = makeKey(rng);
+    if (hi < lo) std::swap(lo, hi);
+    std::vector<Key> expected;
+    for (auto it = reference.lower_bound(lo); it != reference.lower_bound(hi); ++it) expected.push_back(it->first);
+    auto range = tree.range(lo, hi);
+    std::vector<Key> forward, backward;
+    for (auto [key, value] : range) forward.push_back(key);
+    for (auto it = range.rbegin(); it != range.rend(); ++it) backward.push_back((*it).first);
+    std::reverse(backward.begin(), backward.end());
+    errors += forward != expected || backward != expected ? 1 : 0;
+    // hi < lo 是空范围
+    if (lo < hi) errors += tree.range(hi, lo).begin() != tree.range(hi, lo).end() ? 1 : 0;
+  }
+
+  // 删除大部分元素, 空节点被回收后结构仍然正确
+  std::vector<Key> keys;
+  for (const auto &[key, value] : reference) keys.push_back(key);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  keys.resize(keys.size() * 9 / 10);
+  for (const Key &key : keys) errors += tree.erase(key) != reference.erase(key) ? 1 : 0;
+  compareAll();
+
+  // 批量构建的结果与逐个插入相同
+  std::vector<std::pair<Key, int>> items(reference.begin(), reference.end());
+  std::shuffle(items.begin(), items.end(), rng);
+  btree_map<Key, int> bulk(items);
+  tree = std::move(bulk);
+  compareAll();
+  return errors;
+}
+
+/// @brief btree_map 的用法与 std::map 相同, 另外支持 range(lo, hi) 范围查询
+void testBTreeMap()
+{
+  btree_map<int, std::string> tree{{3, "three"}, {1, "one"}, {2, "two"}, {1, "duplicate"}};  // 重复的 key 保留第一个
+  tree[4] = "four";
+  auto [iter1, inserted1] = tree.insert_or_assign(5, "five");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted1, iter1->first, iter1->second);
+  auto [iter2, inserted2] = tree.insert_or_assign(5, "five2");
+  fmt::println("Inserted: {}, Key: {}, Value: {}", inserted2, iter2->first, iter2->second);
+  for (const auto &[key, value] : tree.range(2, 5)) fmt::println("range [2, 5): Key: {}, Value: {}", key, value);
+  for (auto it = tree.rbegin(); it != tree.rend(); ++it) fmt::println("reverse: Key: {}", (*it).first);
+
+  std::size_t errors = checkBTreeMap<std::int32_t>([](std::mt19937 &rng)
+                                                   { return static_cast<std::int32_t>(rng() % 200000) - 100000; },
+                                                   400000);
+  errors += checkBTreeMap<std::uint64_t>([](std::mt19937 &rng)
+                                         { return (std::uint64_t{rng() % 100000} << 47) + rng() % 3; },
+                                         400000);
+  errors += checkBTreeMap<std::string>([](std::mt19937 &rng) { return std::to_string(rng() % 20000); }, 100000);
+  fmt::println("btree_map vs std::map: {} errors", errors);
+}
+
+/// @brief 构建 / 命中查找 / 范围扫描(每次 100 个元素, 按元素计时) / 反向扫描: std::map vs btree_map
+void benchBTreeMap()
+{
+  std::size_t max_keys = 1'000'000;
+  if (const char *env = std::getenv("MAP_BENCH_MAX_KEYS")) max_keys = std::strtoull(env, nullptr, 10);
+  constexpr std::size_t kSpan = 100;
+
+  fmt::println("========== benchmark: std::map vs btree_map (uint64 -> uint64) ==========");
+  fmt::println("  {:>10} {:<24} {:>10} {:>10} {:>10} {:>10}   (ns/op)", "keys", "container", "build", "find hit",
+               "scan", "rev scan");
+  for (std::size_t n = 1000; n <= max_keys; n *= 10)
+  {
+    std::mt19937_64 rng(n);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> items(n);
+    for (auto &[key, value] : items) key = value = rng();
+    std::vector<std::uint64_t> queries(n);
+    for (auto &q : queries) q = items[rng() % n].first;
+    // 范围查询 [sorted[i], sorted[i + kSpan]), 每个范围正好 kSpan 个元素
+    std::vector<std::uint64_t> sorted(n);
+    std::transform(items.begin(), items.end(), sorted.begin(), [](const auto &item) { return item.first; });
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges(std::max<std::size_t>(1, n / kSpan));
+    for (auto &[lo, hi] : ranges)
+    {
+      const std::size_t i = rng() % (n - kSpan);
+      lo = sorted[i];
+      hi = sorted[i + kSpan];
+    }
+    const std::size_t scanned = ranges.size() * kSpan;
+    const std::size_t rounds = std::max<std::size_t>(1, 1'000'000 / n);
+    const auto row = [&](const char *name, double build, double hit, double scan, double rscan)
+    {
+      const auto r = static_cast<double>(rounds);
+      fmt::println("  {:>10} {:<24} {:>10.1f} {:>10.1f} {:>10.2f} {:>10.2f}", n, name, build / r, hit / r, scan / r,
+                   rscan / r);
+    };
+    const auto scanBody = [&](auto &map)
+    {
+      return [&]
+      {
+        std::uint64_t sum = 0;
+        for (const auto &[lo, hi] : ranges)
+        {
+          for (auto it = map.lower_bound(lo); it != map.end() && it->first < hi; ++it) sum += it->second;
+        }
+        bench::doNotOptimize(sum);
+      };
+    };
+    const auto reverseScanBody = [&](auto &map)
+    {
+      return [&]
+      {
+        std::uint64_t sum = 0;
+        for (const auto &[lo, hi] : ranges)
+        {
+          for (auto it = std::make_reverse_iterator(map.lower_bound(hi)); it != map.rend() && (*it).first >= lo; ++it)
+            sum += (*it).second;
+        }
+        bench::doNotOptimize(sum);
+      };
+    };
+
+    double build = 0, hit = 0, scan = 0, rscan = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+      std::map<std::uint64_t, std::uint64_t> map;
+      build += bench::nsPerOp(n, [&] { for (const auto &[key, value] : items) map.insert_or_assign(key, value); });
+      hit += bench::nsPerOp(n, [&] { for (std::uint64_t q : queries) bench::doNotOptimize(map.find(q)->second); });
+      scan += bench::nsPerOp(scanned, scanBody(map));
+      rscan += bench::nsPerOp(scanned, reverseScanBody(map));
+    }
+    row("std::map", build, hit, scan, rscan);
+
+    build = hit = scan = rscan = 0;
+    double bulk = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+      btree_map<std::uint64_t, std::uint64_t> map;
+      build += bench::nsPerOp(n, [&] { for (const auto &[key, value] : items) map.insert_or_assign(key, value); });
+      hit += bench::nsPerOp(n, [&] { for (std::uint64_t q : queries) bench::doNotOptimize(map.find(q)->second); });
+      scan += bench::nsPerOp(scanned, scanBody(map));
+      rscan += bench::nsPerOp(scanned, reverseScanBody(map));
+      bulk += bench::nsPerOp(n, [&] { map = btree_map<std::uint64_t, std::uint64_t>(items); });
+    }
+    row("btree_map", build, hit, scan, rscan);
+    fmt::println("  {:>10} {:<24} {:>10.1f} {:>10} {:>10} {:>10}", n, "  bulk build",
+                 bulk / static_cast<double>(rounds), "-", "-", "-");
+  }
+}
+
+template <typename T>
+using pool_list = std::list<T, node_pool_allocator<T>>;
+template <typename Key, typename T>
+using pool_map = std::map<Key, T, std::less<Key>, node_pool_allocator<std::pair<const Key, T>>>;
+
+/// @brief 把 node_pool_allocator 作为 std::map / std::list 的分配器, 随机插入 / 删除并与默认分配器的容器对比
+void testNodePoolAllocator()
+{
+  pool_map<int, std::string> poolMap{{1, "one"}, {2, "two"}, {3, "three"}};
+  poolMap[4] = "four";
+  poolMap.insert_or_assign(5, "five");
+  for (const auto &[key, value] : poolMap) fmt::println("Key: {}, Value: {}", key, value);
+  const node_pool::Stats &stats = poolMap.get_allocator().pool().stats();
+  fmt::println("pool: {} chunks, {} bytes reserved, {} blocks in use", stats.chunks, stats.reserved_bytes,
+               stats.in_use_blocks);
+
+  std::map<int, std::string> reference(poolMap.begin(), poolMap.end());
+  std::mt19937 rng(4);
+  std::size_t errors = 0;
+  for (int i = 0; i < 200000; ++i)
+  {
+    const int key = static_cast<int>(rng() % 5000);
+    if (rng() % 2 == 0)
+    {
+      poolMap.insert_or_assign(key, std::to_string(i));
+      reference.insert_or_assign(key, std::to_string(i));
+    }
+    else
+    {
+      errors += poolMap.erase(key) != reference.erase(key) ? 1 : 0;
+    }
+  }
+  errors += !std::equal(poolMap.begin(), poolMap.end(), reference.begin(), reference.end()) ? 1 : 0;
+  // 每个元素一个块(有些标准库还会为哨兵节点等分配少量的块)
+  errors += stats.in_use_blocks < poolMap.size() ? 1 : 0;
+
+  // 拷贝得到新的池, 移动时池跟着元素走
+  pool_map<int, std::string> copy = poolMap;
+  errors += copy.get_allocator() == poolMap.get_allocator() || copy != poolMap ? 1 : 0;
+  const auto allocator = poolMap.get_allocator();
+  pool_map<int, std::string> moved = std::move(poolMap);
+  errors += moved.get_allocator() != allocator || moved != copy ? 1 : 0;
+
+  pool_list<int> poolList;
+  std::list<int> referenceList;
+  for (int i = 0; i < 100000; ++i)
+  {
+    if (rng() % 3 != 0 || poolList.empty())
+    {
+      poolList.push_back(i);
+      referenceList.push_back(i);
+    }
+    else
+    {
+      poolList.pop_front();
+      referenceList.pop_front();
+    }
+  }
+  errors += !std::equal(poolList.begin(), poolList.end(), referenceList.begin(), referenceList.end()) ? 1 : 0;
+  fmt::println("node_pool_allocator vs std::allocator: {} errors", errors);
+}
+
+/// @brief 当前全局堆中已分配的字节数(依赖 glibc 2.33+ 的 mallinfo2, 其他平台返回 0)
+std::size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+struct ChurnResult
+{
+  double build = 0;    // 插入 n 个元素, ns/元素
+  double churn = 0;    // 删除一个随机元素 + 插入一个新元素, ns/次
+  double iterate = 0;  // 遍历, ns/元素
+  double bytes = 0;    // 每个元素占用的堆内存
+};
+
+/// @brief std::map<int, std::string>: 构建 n 个元素, 再做 n 次 "随机删除 + 插入", 重复 rounds 次
+template <typename Map>
+ChurnResult churnMap(std::size_t n, std::size_t rounds)
+{
+  ChurnResult result;
+  std::mt19937 rng(static_cast<unsigned>(n));
+  for (std::size_t r = 0; r < rounds; ++r)
+  {
+    std::uint32_t next = 0;
+    const auto newKey = [&] { return static_cast<int>(next++ * 2654435761u); };  // 奇数乘法是双射, key 不重复
+    std::vector<int> live(n);
+    const std::size_t heapBefore = heapInUse();
+    Map map;
+    result.build += bench::nsPerOp(n, [&]
+                                   {
+                                     for (int &key : live)
+                                     {
+                                       key = newKey();
+                                       map.try_emplace(key, std::to_string(key % 1000));
+                                     }
+                                   });
+    if (r == 0) result.bytes = static_cast<double>(heapInUse() - heapBefore) / static_cast<double>(n);
+    result.churn += bench::nsPerOp(n, [&]
+                                   {
+                                     for (std::size_t i = 0; i < n; ++i)
+                                     {
+                                       int &key = live[rng() % n];
+                                       map.erase(key);
+                                       key = newKey();
+                                       map.try_emplace(key, std::to_string(key % 1000));
+                                     }
+                                   });
+    result.iterate += bench::nsPerOp(n, [&]
+                                     {
+                                       std::size_t sum = 0;
+                                       for (const auto &[key, value] : map) sum += value.size();
+                                       bench::doNotOptimize(sum);
+                                     });
+  }
+  result.build /= static_cast<double>(rounds);
+  result.churn /= static_cast<double>(rounds);
+  result.iterate /= static_cast<double>(rounds);
+  return result;
+}
+
+/// @brief std::list<int>: 构建 n 个元素, 再做 n 次 "删除随机位置的元素 + push_back", 重复 rounds 次
+template <typename List>
+ChurnResult churnList(std::size_t n, std::size_t rounds)
+{
+  ChurnResult result;
+  std::mt19937 rng(static_cast<unsigned>(n));
+  for (std::size_t r = 0; r < rounds; ++r)
+  {
+    std::vector<typename List::iterator> live(n);
+    const std::size_t heapBefore = heapInUse();
+    List list;
+    int value = 0;
+    result.build += bench::nsPerOp(n, [&] { for (auto &it : live) it = list.insert(list.end(), value++); });
+    if (r == 0) result.bytes = static_cast<double>(heapInUse() - heapBefore) / static_cast<double>(n);
+    result.churn += bench::nsPerOp(n, [&]
+                                   {
+                                     for (std::size_t i = 0; i < n; ++i)
+                                     {
+                                       auto &it = live[rng() % n];
+                                       list.erase(it);
+                                       it = list.insert(list.end(), value++);
+                                     }
+                                   });
+    result.iterate += bench::nsPerOp(n, [&]
+                                     {
+                                       long long sum = 0;
+                                       for (int v : list) sum += v;
+                                       bench::doNotOptimize(sum);
+                                     });
+  }
+  result.build /= static_cast<double>(rounds);
+  result.churn /= static_cast<double>(rounds);
+  result.iterate /= static_cast<double>(rounds);
+  return result;
+}
+
+/// @brief 默认分配器 vs node_pool_allocator: 插入 / 删除插入交替 / 遍历的耗时, 以及每个元素占用的堆内存
+void benchNodePoolAllocator()
+{
+  std::size_t max_keys = 1'000'000;
+  if (const char *env = std::getenv("MAP_BENCH_MAX_KEYS")) max_keys = std::strtoull(env, nullptr, 10);
+
+  fmt::println("========== benchmark: std::allocator vs node_pool_allocator ==========");
+  fmt::println("  {:>10} {:<40} {:>8} {:>8} {:>8} {:>10}", "elements", "container", "build", "churn", "iterate",
+               "bytes/elem");
+  const auto row = [](std::size_t n, const char *name, const ChurnResult &r)
+  {
+    if (heapInUse() == 0)  // 没有 mallinfo2 时不显示内存
+      fmt::println("  {:>10} {:<40} {:>8.1f} {:>8.1f} {:>8.2f} {:>10}", n, name, r.build, r.churn, r.iterate, "-");
+    else
+      fmt::println("  {:>10} {:<40} {:>8.1f} {:>8.1f} {:>8.2f} {:>10.1f}", n, name, r.build, r.churn, r.iterate,
+                   r.bytes);
+  };
+  for (std::size_t n = 1000; n <= max_keys; n *= 10)
+  {
+    const std::size_t rounds = std::max<std::size_t>(1, 1'000'000 / n);
+    row(n, "std::map<int, std::string>", churnMap<std::map<int, std::string>>(n, rounds));
+    row(n, "  with node_pool_allocator", churnMap<pool_map<int, std::string>>(n, rounds));
+    row(n, "std::list<int>", churnList<std::list<int>>(n, rounds));
+    row(n, "  with node_pool_allocator", churnList<pool_list<int>>(n, rounds));
+  }
+  fmt::println("  (ns/op; bytes/elem 是插入之后全局堆增加的字节数除以元素个数)");
+}
 
 int main()
 {
@@ -25,6 +661,15 @@ int main()
     std::cout << "Key: " << key << ", Value: " << value << '\n';
   }
 
+  testFlatHashMap();
+  benchFlatHashMap();
+  testFlatMap();
+  benchFlatMap();
+  testBTreeMap();
+  benchBTreeMap();
+  testNodePoolAllocator();
+  benchNodePoolAllocator();
+
   std::cout << "Map Demo\n";
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 每个容器独享的节点内存池, 用作 std::map / std::set / std::list 的 Allocator 参数.
+ *
+ * std::map<int, std::string> 每插入一个元素就调用一次 operator new 分配一个节点, 删除时再释放;
+ * 节点分散在全局堆上, malloc 还要为每个块保存头部信息(glibc 为 8 字节, 并按 16 字节取整).
+ * node_pool 向系统申请大块内存(chunk), 从中顺序切出节点, 释放的节点放进对应大小的空闲链表, 下次分配直接复用:
+ *   - 大小按 8 字节分级(8, 16, ... 256 字节), 没有块头, map<int, std::string> 的 72 字节节点只占 72 字节;
+ *   - chunk 从 1KB 开始每次翻倍, 最大 64KB, 元素很少的容器不会预留太多内存;
+ *   - 同一个容器的节点集中在少数几个 chunk 中, 遍历时的缓存局部性更好;
+ *   - 超过 256 字节或对齐要求超过 8 字节的分配直接使用 operator new.
+ * node_pool_allocator<T> 通过 shared_ptr 共享一个 node_pool: 容器内部 rebind 得到的节点分配器与容器的分配器使用同一个池,
+ * 默认构造的分配器创建新的池, 拷贝容器时新容器也得到自己的池(select_on_container_copy_construction).
+ * 容器和它的所有分配器都销毁之后, 池中的内存一次性归还系统; 删除元素时内存只回到空闲链表, 不会归还系统.
+ * node_pool 不是线程安全的, 与容器本身的线程安全性相同.
+ */
+class node_pool
+{
+ public:
+  static constexpr std::size_t kGranularity = 8;     // 大小级别的间隔, 也是块的对齐
+  static constexpr std::size_t kMaxBlockSize = 256;  // 超过这个大小直接使用 operator new
+  static constexpr std::size_t kMinChunkSize = 1024;
+  static constexpr std::size_t kMaxChunkSize = 64 * 1024;
+
+  /// @brief 内存池的统计信息
+  struct Stats
+  {
+    std::size_t chunks = 0;          // 向系统申请的大块数量
+    std::size_t reserved_bytes = 0;  // 向系统申请的总字节数
+    std::size_t in_use_blocks = 0;   // 正在使用的块数量
+    std::size_t in_use_bytes = 0;    // 正在使用的块的总字节数(按大小级别取整)
+  };
+
+  node_pool() = default;
+  node_pool(const node_pool &) = delete;
+  node_pool &operator=(const node_pool &) = delete;
+  ~node_pool()
+  {
+    for (void *chunk : chunks_) ::operator delete(chunk);
+  }
+
+  void *allocate(std::size_t bytes, std::size_t alignment)
+  {
+    if (bytes > kMaxBlockSize || alignment > kGranularity) return ::operator new(bytes, std::align_val_t{alignment});
+    const std::size_t index = classIndex(bytes);
+    const std::size_t block_size = (index + 1) * kGranularity;
+    ++stats_.in_use_blocks;
+    stats_.in_use_bytes += block_size;
+    if (FreeBlock *block = free_lists_[index])
+    {
+      free_lists_[index] = block->next;
+      return block;
+    }
+    // 空闲链表为空: 从当前 chunk 中顺序切出一块
+    if (static_cast<std::size_t>(end_ - cur_) < block_size) grow();
+    void *p = cur_;
+    cur_ += block_size;
+    return p;
+  }
+
+  void deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+  {
+    if (bytes > kMaxBlockSize || alignment > kGranularity)
+    {
+      ::operator delete(p, std::align_val_t{alignment});
+      return;
+    }
+    const std::size_t index = classIndex(bytes);
+    free_lists_[index] = ::new (p) FreeBlock{free_lists_[index]};
+    --stats_.in_use_blocks;
+    stats_.in_use_bytes -= (index + 1) * kGranularity;
+  }
+
+  [[nodiscard]] const Stats &stats() const noexcept
+  {
+    return stats_;
+  }
+
+ private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+  static_assert(sizeof(FreeBlock) <= kGranularity && alignof(FreeBlock) <= kGranularity);
+
+  static constexpr std::size_t kClassCount = kMaxBlockSize / kGranularity;
+
+  static constexpr std::size_t classIndex(std::size_t bytes) noexcept
+  {
+    return bytes == 0 ? 0 : (bytes - 1) / kGranularity;
+  }
+
+  /// @brief 申请新的 chunk, 大小是上一个的两倍. 旧 chunk 剩下的不足一个块的尾部被丢弃
+  void grow()
+  {
+    const std::size_t size = chunks_.empty() ? kMinChunkSize : std::min(kMaxChunkSize, next_chunk_size_);
+    chunks_.reserve(chunks_.size() + 1);
+    cur_ = static_cast<std::byte *>(::operator new(size));
+    end_ = cur_ + size;
+    chunks_.push_back(cur_);
+    next_chunk_size_ = size * 2;
+    ++stats_.chunks;
+    stats_.reserved_bytes += size;
+  }
+
+  FreeBlock *free_lists_[kClassCount] = {};
+  std::byte *cur_ = nullptr;
+  std::byte *end_ = nullptr;
+  std::size_t next_chunk_size_ = kMinChunkSize;
+  std::vector<void *> chunks_;
+  Stats stats_;
+};
+
+template <typename T>
+class node_pool_allocator
+{
+ public:
+  using value_type = T;
+  // 移动 / 交换容器时内存池跟着容器走; 拷贝赋值时保留自己的池
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /// @brief 创建一个新的内存池
+  node_pool_allocator() : pool_(std::make_shared<node_pool>()) {}
+
+  // 只声明拷贝构造, 移动也是拷贝: 被移动的容器仍然持有可用的池
+  node_pool_allocator(const node_pool_allocator &) noexcept = default;
+  node_pool_allocator &operator=(const node_pool_allocator &) noexcept = default;
+
+  template <typename U>
+  node_pool_allocator(const node_pool_allocator<U> &other) noexcept : pool_(other.pool_)  // NOLINT
+  {
+  }
+
+  T *allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+    return static_cast<T *>(pool_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept
+  {
+    pool_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  /// @brief 拷贝出来的容器使用新的池
+  node_pool_allocator select_on_container_copy_construction() const
+  {
+    return node_pool_allocator();
+  }
+
+  [[nodiscard]] const node_pool &pool() const noexcept
+  {
+    return *pool_;
+  }
+
+ private:
+  template <typename U>
+  friend class node_pool_allocator;
+
+  std::shared_ptr<node_pool> pool_;
+};
+
+template <typename T, typename U>
+bool operator==(const node_pool_allocator<T> &a, const node_pool_allocator<U> &b) noexcept
+{
+  return &a.pool() == &b.pool();
+}
+
+template <typename T, typename U>
+bool operator!=(const node_pool_allocator<T> &a, const node_pool_allocator<U> &b) noexcept
+{
+  return &a.pool() != &b.pool();
+}
@@ -0,0 +1,517 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// mremap 是 Linux 特有的(需要 _GNU_SOURCE, g++ / clang++ 在 Linux 上默认定义)
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+#define FAST_VECTOR_MREMAP 1
+#else
+#define FAST_VECTOR_MREMAP 0
+#endif
+
+/**
+ * 增长策略可配置的 vector, 针对大量 push_back 的场景减少扩容时的拷贝.
+ *
+ * std::vector 每次扩容都是 "分配新内存 -> 逐个移动元素 -> 析构旧元素 -> 释放旧内存", 即使元素是 int 也要完整地拷贝一遍,
+ * 而且新旧两块内存同时存在, 峰值内存是数据量的 2.5 ~ 3 倍. fast_vector 的做法:
+ *   - 增长策略是模板参数(growth_factor<Num, Den>), 默认 2 倍, 也可以用 1.5 倍等, 或者自己实现 next();
+ *   - 可平凡搬移(trivially relocatable, 按字节复制到新地址后直接丢弃旧对象是安全的)的类型用 std::realloc 扩容,
+ *     分配器能原地扩展时不需要复制;
+ *   - Linux 上超过 32MB(glibc 自动改用 mmap 的上限)的缓冲区直接用 mmap 分配并建议使用大页,
+ *     扩容时 mremap 只修改页表, 不复制数据, 也不需要同时保留两份内存;
+ *   - resize_default_init(n): 新增的元素只做默认初始化(int 不清零), 适合马上就要被覆盖的缓冲区, 例如 read() 的目标;
+ *   - reserve_more(n): 保证还能再放 n 个元素, 按增长策略扩容; 反复调用 reserve(size() + n) 每次只增长一点, 总代价是 O(n^2).
+ * 其他类型(例如 libstdc++ 的 std::string 内部有指向自身的指针)与 std::vector 相同, 逐个移动元素.
+ * is_trivially_relocatable<T> 默认等于 std::is_trivially_copyable<T>, 可以为自己的类型特化.
+ * 迭代器就是 T *, 扩容后失效. 元素的对齐不能超过 alignof(std::max_align_t).
+ */
+
+/// @brief T 能否按字节搬移到新地址(之后不再对旧地址调用析构函数)
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{
+};
+
+/// @brief std::unique_ptr 只保存一个指针, 按字节搬移是安全的
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type
+{
+};
+
+/// @brief 容量按 Num / Den 倍增长, 最少 kMinCapacity 个元素
+template <std::size_t Num, std::size_t Den = 1>
+struct growth_factor
+{
+  static_assert(Num > Den, "growth factor must be greater than 1");
+  static constexpr std::size_t kMinCapacity = 8;
+
+  /// @brief 当前容量为 capacity, 至少需要 required 个元素时的新容量
+  static constexpr std::size_t next(std::size_t capacity, std::size_t required) noexcept
+  {
+    const std::size_t grown = capacity + capacity / Den * (Num - Den);
+    return std::max({required, grown, kMinCapacity});
+  }
+};
+
+using growth_double = growth_factor<2>;
+using growth_golden = growth_factor<3, 2>;
+
+template <typename T, typename Growth = growth_double>
+class fast_vector
+{
+  static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+  static constexpr bool kRelocatable = is_trivially_relocatable<T>::value;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  /// @brief 超过这个大小的缓冲区使用 mmap / mremap(仅 Linux, 且 T 可平凡搬移)
+  static constexpr std::size_t kMapThreshold = std::size_t{32} << 20;
+
+  fast_vector() noexcept = default;
+
+  explicit fast_vector(size_type n)
+  {
+    resize(n);
+  }
+  fast_vector(size_type n, const T &value)
+  {
+    resize(n, value);
+  }
+  fast_vector(std::initializer_list<T> init)
+  {
+    if (init.size() == 0) return;
+    reallocate(init.size());
+    std::uninitialized_copy(init.begin(), init.end(), data_);
+    size_ = init.size();
+  }
+
+  fast_vector(const fast_vector &other)
+  {
+    if (other.size_ == 0) return;
+    reallocate(other.size_);
+    std::uninitialized_copy(other.begin(), other.end(), data_);
+    size_ = other.size_;
+  }
+  fast_vector(fast_vector &&other) noexcept
+  {
+    swap(other);
+  }
+  fast_vector &operator=(const fast_vector &other)
+  {
+    if (this != &other) fast_vector(other).swap(*this);
+    return *this;
+  }
+  fast_vector &operator=(fast_vector &&other) noexcept
+  {
+    fast_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+  ~fast_vector()
+  {
+    clear();
+    release();
+  }
+
+  void swap(fast_vector &other) noexcept
+  {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(mapped_bytes_, other.mapped_bytes_);
+  }
+
+  // ---------------- 元素访问 ----------------
+  T &operator[](size_type i) noexcept
+  {
+    return data_[i];
+  }
+  const T &operator[](size_type i) const noexcept
+  {
+    return data_[i];
+  }
+  T &at(size_type i)
+  {
+    if (i >= size_) throw std::out_of_range("fast_vector::at: index out of range");
+    return data_[i];
+  }
+  const T &at(size_type i) const
+  {
+    return const_cast<fast_vector *>(this)->at(i);
+  }
+  T &front() noexcept
+  {
+    return data_[0];
+  }
+  const T &front() const noexcept
+  {
+    return data_[0];
+  }
+  T &back() noexcept
+  {
+    return data_[size_ - 1];
+  }
+  const T &back() const noexcept
+  {
+    return data_[size_ - 1];
+  }
+  T *data() noexcept
+  {
+    return data_;
+  }
+  const T *data() const noexcept
+  {
+    return data_;
+  }
+
+  // ---------------- 迭代器 ----------------
+  iterator begin() noexcept
+  {
+    return data_;
+  }
+  iterator end() noexcept
+  {
+    return data_ + size_;
+  }
+  const_iterator begin() const noexcept
+  {
+    return data_;
+  }
+  const_iterator end() const noexcept
+  {
+    return data_ + size_;
+  }
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+  reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  // ---------------- 容量 ----------------
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_;
+  }
+  [[nodiscard]] size_type capacity() const noexcept
+  {
+    return capacity_;
+  }
+  [[nodiscard]] static constexpr size_type max_size() noexcept
+  {
+    return std::numeric_limits<difference_type>::max() / sizeof(T);
+  }
+  /// @brief 当前缓冲区是否由 mmap 分配
+  [[nodiscard]] bool is_mapped() const noexcept
+  {
+    return mapped_bytes_ != 0;
+  }
+
+  /// @brief 与 std::vector::reserve 相同: 容量扩展到恰好 n
+  void reserve(size_type n)
+  {
+    if (n > capacity_) reallocate(checkSize(n));
+  }
+
+  /// @brief 保证还能再放 n 个元素, 容量不足时按增长策略扩容
+  void reserve_more(size_type n)
+  {
+    if (n > capacity_ - size_) reallocate(Growth::next(capacity_, checkSize(size_ + n)));
+  }
+
+  void shrink_to_fit()
+  {
+    if (size_ == capacity_) return;
+    if (size_ == 0)
+    {
+      release();
+      return;
+    }
+    reallocate(size_);
+  }
+
+  // ---------------- 修改 ----------------
+  void clear() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<T>) std::destroy(begin(), end());
+    size_ = 0;
+  }
+
+  void push_back(const T &value)
+  {
+    emplace_back(value);
+  }
+  void push_back(T &&value)
+  {
+    emplace_back(std::move(value));
+  }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args)
+  {
+    if (size_ == capacity_) return growAndEmplaceBack(std::forward<Args>(args)...);
+    T *p = ::new (static_cast<void *>(data_ + size_)) T(std::forward<Args>(args)...);
+    ++size_;
+    return *p;
+  }
+
+  void pop_back() noexcept
+  {
+    --size_;
+    if constexpr (!std::is_trivially_destructible_v<T>) data_[size_].~T();
+  }
+
+  /// @brief 新增的元素做值初始化(int 为 0), 与 std::vector::resize 相同
+  void resize(size_type n)
+  {
+    resizeWith(n, [](T *first, T *last) { std::uninitialized_value_construct(first, last); });
+  }
+  void resize(size_type n, const T &value)
+  {
+    if (n > capacity_ && &value >= data_ && &value < data_ + size_)  // value 是自己的元素, 扩容后会失效
+    {
+      const T copy(value);
+      resize(n, copy);
+      return;
+    }
+    resizeWith(n, [&](T *first, T *last) { std::uninitialized_fill(first, last, value); });
+  }
+  /// @brief 新增的元素只做默认初始化: int 等平凡类型不清零, 内容是未确定的, 写入之前不能读取
+  void resize_default_init(size_type n)
+  {
+    resizeWith(n, [](T *first, T *last) { std::uninitialized_default_construct(first, last); });
+  }
+
+  /// @brief 在 pos 之前插入 value, 返回指向新元素的迭代器
+  iterator insert(const_iterator pos, T value)
+  {
+    const size_type index = static_cast<size_type>(pos - data_);
+    if (size_ == capacity_) reallocate(Growth::next(capacity_, checkSize(size_ + 1)));
+    T *slot = data_ + index;
+    if constexpr (kRelocatable)
+    {
+      // 后面的元素整体按字节后移一位, 空出来的位置直接构造
+      std::memmove(static_cast<void *>(slot + 1), static_cast<const void *>(slot), (size_ - index) * sizeof(T));
+      ::new (static_cast<void *>(slot)) T(std::move(value));
+      ++size_;
+    }
+    else
+    {
+      emplace_back(std::move(value));
+      std::rotate(slot, data_ + size_ - 1, data_ + size_);
+    }
+    return slot;
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    return erase(pos, pos + 1);
+  }
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    T *f = data_ + (first - data_);
+    T *l = data_ + (last - data_);
+    if (f != l)
+    {
+      T *new_end = std::move(l, end(), f);
+      if constexpr (!std::is_trivially_destructible_v<T>) std::destroy(new_end, end());
+      size_ -= static_cast<size_type>(l - f);
+    }
+    return f;
+  }
+
+ private:
+  static size_type checkSize(size_type n)
+  {
+    if (n > max_size()) throw std::length_error("fast_vector: size exceeds max_size()");
+    return n;
+  }
+
+  template <typename... Args>
+  T &growAndEmplaceBack(Args &&...args)
+  {
+    // 先在局部变量中构造: args 可能引用自己的元素, 扩容之后会失效
+    T value(std::forward<Args>(args)...);
+    reallocate(Growth::next(capacity_, checkSize(size_ + 1)));
+    T *p = ::new (static_cast<void *>(data_ + size_)) T(std::move(value));
+    ++size_;
+    return *p;
+  }
+
+  template <typename Construct>
+  void resizeWith(size_type n, Construct construct)
+  {
+    if (n <= size_)
+    {
+      if constexpr (!std::is_trivially_destructible_v<T>) std::destroy(data_ + n, end());
+      size_ = n;
+      return;
+    }
+    if (n > capacity_) reallocate(Growth::next(capacity_, checkSize(n)));
+    construct(data_ + size_, data_ + n);
+    size_ = n;
+  }
+
+  /// @brief 把缓冲区换成恰好 new_cap 个元素(mmap 时按页取整), new_cap >= size_
+  void reallocate(size_type new_cap)
+  {
+    if constexpr (kRelocatable)
+    {
+      const size_type new_bytes = new_cap * sizeof(T);
+#if FAST_VECTOR_MREMAP
+      if (new_bytes >= kMapThreshold)
+      {
+        const size_type map_bytes = roundToPage(new_bytes);
+        void *p = MAP_FAILED;
+        if (mapped_bytes_ != 0)
+        {
+          // 修改页表即可, 不复制数据; 原地没有空间时内核把这些页移动到新的虚拟地址
+          p = ::mremap(data_, mapped_bytes_, map_bytes, MREMAP_MAYMOVE);
+          if (p == MAP_FAILED) throw std::bad_alloc();
+        }
+        else
+        {
+          p = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+          if (p == MAP_FAILED) throw std::bad_alloc();
+          if (size_ != 0) std::memcpy(p, static_cast<const void *>(data_), size_ * sizeof(T));
+          std::free(data_);
+        }
+#if defined(MADV_HUGEPAGE)
+        // 建议内核使用 2MB 大页: 首次写入时缺页中断的次数少 512 倍(透明大页为 madvise 模式时才需要)
+        ::madvise(p, map_bytes, MADV_HUGEPAGE);
+#endif
+        data_ = static_cast<T *>(p);
+        mapped_bytes_ = map_bytes;
+        capacity_ = map_bytes / sizeof(T);
+        return;
+      }
+      if (mapped_bytes_ != 0)  // shrink_to_fit 之后缓冲区变小: 换回堆内存
+      {
+        void *p = std::malloc(new_bytes);
+        if (p == nullptr) throw std::bad_alloc();
+        std::memcpy(p, static_cast<const void *>(data_), size_ * sizeof(T));
+        ::munmap(data_, mapped_bytes_);
+        mapped_bytes_ = 0;
+        data_ = static_cast<T *>(p);
+        capacity_ = new_cap;
+        return;
+      }
+#endif
+      // realloc 失败时原来的缓冲区不变
+      void *p = std::realloc(static_cast<void *>(data_), new_bytes);
+      if (p == nullptr) throw std::bad_alloc();
+      data_ = static_cast<T *>(p);
+      capacity_ = new_cap;
+    }
+    else
+    {
+      T *p = static_cast<T *>(std::malloc(new_cap * sizeof(T)));
+      if (p == nullptr) throw std::bad_alloc();
+      try
+      {
+        // 移动构造可能抛异常时退回拷贝, 保证扩容失败时原来的元素不变(与 std::vector 相同)
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+          std::uninitialized_move(begin(), end(), p);
+        else
+          std::uninitialized_copy(begin(), end(), p);
+      }
+      catch (...)
+      {
+        std::free(p);
+        throw;
+      }
+      std::destroy(begin(), end());
+      std::free(data_);
+      data_ = p;
+      capacity_ = new_cap;
+    }
+  }
+
+  /// @brief 释放缓冲区, 调用前元素已经析构
+  void release() noexcept
+  {
+#if FAST_VECTOR_MREMAP
+    if (mapped_bytes_ != 0)
+      ::munmap(data_, mapped_bytes_);
+    else
+      std::free(data_);
+#else
+    std::free(data_);
+#endif
+    data_ = nullptr;
+    capacity_ = 0;
+    mapped_bytes_ = 0;
+  }
+
+#if FAST_VECTOR_MREMAP
+  static size_type roundToPage(size_type bytes) noexcept
+  {
+    static const size_type page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+  }
+#endif
+
+  T *data_ = nullptr;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+  size_type mapped_bytes_ = 0;  // 不为 0 时缓冲区由 mmap 分配
+};
+
+template <typename T, typename Growth>
+bool operator==(const fast_vector<T, Growth> &a, const fast_vector<T, Growth> &b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template <typename T, typename Growth>
+bool operator!=(const fast_vector<T, Growth> &a, const fast_vector<T, Growth> &b)
+{
+  return !(a == b);
+}
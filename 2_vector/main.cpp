@@ -1,7 +1,18 @@
+#include <fmt/core.h>
+
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "bench.hpp"
+#include "fast_vector.hpp"
+
 /// @brief 打印vector函数
 /// @tparam T
 /// @param vec
@@ -15,8 +26,206 @@ void printVector(const std::vector<T> &vec)
   std::cout << '\n';
 }
 
+/// @brief 随机 push_back / pop_back / insert / erase / resize, 每一步之后与 std::vector 对比
+template <typename T, typename Growth, typename MakeValue>
+std::size_t checkFastVector(MakeValue makeValue, int ops)
+{
+  fast_vector<T, Growth> vec;
+  std::vector<T> reference;
+  std::mt19937 rng(5);
+  std::size_t errors = 0;
+  for (int i = 0; i < ops; ++i)
+  {
+    switch (rng() % 8)
+    {
+      case 0:
+      case 1:
+      case 2:
+        vec.push_back(makeValue(i));
+        reference.push_back(makeValue(i));
+        break;
+      case 3:
+        if (!reference.empty())
+        {
+          vec.pop_back();
+          reference.pop_back();
+        }
+        break;
+      case 4:
+      {
+        const std::size_t pos = rng() % (reference.size() + 1);
+        vec.insert(vec.begin() + pos, makeValue(i));
+        reference.insert(reference.begin() + static_cast<std::ptrdiff_t>(pos), makeValue(i));
+        break;
+      }
+      case 5:
+        if (!reference.empty())
+        {
+          const std::size_t first = rng() % reference.size();
+          const std::size_t last = first + rng() % std::min<std::size_t>(4, reference.size() - first + 1);
+          vec.erase(vec.begin() + first, vec.begin() + last);
+          reference.erase(reference.begin() + static_cast<std::ptrdiff_t>(first),
+                          reference.begin() + static_cast<std::ptrdiff_t>(last));
+        }
+        break;
+      case 6:
+      {
+        const std::size_t n = rng() % 2000;
+        vec.resize(n, makeValue(i));
+        reference.resize(n, makeValue(i));
+        break;
+      }
+      default:
+        vec.reserve_more(rng() % 100);
+        if (rng() % 16 == 0) vec.shrink_to_fit();
+    }
+    errors += !std::equal(vec.begin(), vec.end(), reference.begin(), reference.end()) ? 1 : 0;
+  }
+  fast_vector<T, Growth> copy = vec;
+  errors += copy != vec ? 1 : 0;
+  fast_vector<T, Growth> moved = std::move(copy);
+  errors += moved != vec || !copy.empty() ? 1 : 0;
+  return errors;
+}
+
+/// @brief fast_vector 的用法与 std::vector 相同, 另外可以选择增长策略和使用 resize_default_init
+void testFastVector()
+{
+  fast_vector<int> vec{1, 2, 3, 4, 5};
+  vec.push_back(6);
+  vec.insert(vec.begin() + 2, 99);
+  vec.erase(vec.begin() + 1);
+  std::string text;
+  for (int v : vec) text += std::to_string(v) + ' ';
+  fmt::println("fast_vector: {}(size {}, capacity {})", text, vec.size(), vec.capacity());
+
+  // resize_default_init: 新增的元素不清零, 马上被覆盖, 例如作为 read / memcpy 的目标缓冲区
+  fast_vector<char> buffer;
+  const std::string_view payload = "hello, fast_vector";
+  buffer.resize_default_init(payload.size());
+  std::copy(payload.begin(), payload.end(), buffer.begin());
+  fmt::println("buffer: {}", std::string_view(buffer.data(), buffer.size()));
+
+  // 超过 32MB 之后(Linux)改用 mmap, 继续扩容时 mremap 不复制数据
+  fast_vector<int> big;
+  for (int i = 0; i < 10'000'000; ++i) big.push_back(i);
+  fmt::println("10M ints: capacity {}, mmap: {}", big.capacity(), big.is_mapped());
+
+  std::size_t errors = checkFastVector<int, growth_double>([](int i) { return i; }, 100000);
+  errors += checkFastVector<int, growth_golden>([](int i) { return -i; }, 100000);
+  errors += checkFastVector<std::string, growth_double>([](int i) { return std::string(i % 40, 'x'); }, 50000);
+  for (std::size_t i = 0; i < big.size(); ++i) errors += big[i] != static_cast<int>(i) ? 1 : 0;
+  big.resize(100);
+  big.shrink_to_fit();  // 缩小后换回堆内存
+  errors += big.is_mapped() || big.capacity() != 100 || big.back() != 99 ? 1 : 0;
+
+  // std::unique_ptr 特化为可平凡搬移, 扩容时直接 realloc
+  fast_vector<std::unique_ptr<int>> pointers;
+  for (int i = 0; i < 10000; ++i) pointers.push_back(std::make_unique<int>(i));
+  for (int i = 0; i < 10000; ++i) errors += *pointers[i] != i ? 1 : 0;
+  fmt::println("fast_vector vs std::vector: {} errors", errors);
+}
+
+/// @brief push_back 时缓冲区地址改变的次数(std::vector 每次扩容都要复制全部元素)
+template <typename Vec>
+std::size_t countMoves(std::size_t n)
+{
+  Vec vec;
+  std::size_t moves = 0;
+  const int *last = nullptr;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    vec.push_back(static_cast<int>(i));
+    if (vec.data() != last)
+    {
+      moves += last != nullptr ? 1 : 0;
+      last = vec.data();
+    }
+  }
+  return moves;
+}
+
+template <typename Vec>
+void pushBackN(std::size_t n)
+{
+  Vec vec;
+  for (std::size_t i = 0; i < n; ++i) vec.push_back(static_cast<int>(i));
+  bench::doNotOptimize(vec.data());
+}
+
+/// @brief push_back n 个 int, 从 1K 到 VECTOR_BENCH_MAX(默认 1000 万), 每次乘以 10.
+/// 设置为 1000000000 可以测试 10 亿个元素, 此时 std::vector 扩容的峰值内存约 6GB
+void benchFastVector()
+{
+  std::size_t max_elements = 10'000'000;
+  if (const char *env = std::getenv("VECTOR_BENCH_MAX")) max_elements = std::strtoull(env, nullptr, 10);
+
+  fmt::println("========== benchmark: std::vector<int> vs fast_vector<int> ==========");
+  fmt::println("  {:>10} {:<44} {:>8} {:>8}", "elements", "workload", "ns/op", "moved");
+  for (std::size_t n = 1000; n <= max_elements; n *= 10)
+  {
+    const std::size_t rounds = std::max<std::size_t>(1, 10'000'000 / n);
+    const auto run = [&](const char *name, std::size_t moves, auto body)
+    {
+      const double ns = bench::nsPerOp(n * rounds, [&] { for (std::size_t r = 0; r < rounds; ++r) body(); });
+      if (moves == static_cast<std::size_t>(-1))  // 不统计
+        fmt::println("  {:>10} {:<44} {:>8.3f} {:>8}", n, name, ns, "-");
+      else
+        fmt::println("  {:>10} {:<44} {:>8.3f} {:>8}", n, name, ns, moves);
+    };
+    using golden_vector = fast_vector<int, growth_golden>;
+    const std::size_t none = static_cast<std::size_t>(-1);
+
+    run("std::vector push_back", countMoves<std::vector<int>>(n), [n] { pushBackN<std::vector<int>>(n); });
+    run("fast_vector<growth_double> push_back", countMoves<fast_vector<int>>(n),
+        [n] { pushBackN<fast_vector<int>>(n); });
+    run("fast_vector<growth_golden> push_back", countMoves<golden_vector>(n), [n] { pushBackN<golden_vector>(n); });
+    run("std::vector reserve(n) + push_back", none,
+        [n]
+        {
+          std::vector<int> v;
+          v.reserve(n);
+          for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+          bench::doNotOptimize(v.data());
+        });
+    run("fast_vector reserve_more(256) + push_back x256", none,
+        [n]
+        {
+          // 每次追加一批元素: 按增长策略扩容, 不会退化成每批都重新分配
+          fast_vector<int> v;
+          for (std::size_t i = 0; i < n; i += 256)
+          {
+            v.reserve_more(256);
+            for (std::size_t j = i; j < std::min(n, i + 256); ++j) v.push_back(static_cast<int>(j));
+          }
+          bench::doNotOptimize(v.data());
+        });
+    run("std::vector resize(n) + fill", none,
+        [n]
+        {
+          std::vector<int> v;
+          v.resize(n);
+          for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i);
+          bench::doNotOptimize(v.data());
+        });
+    run("fast_vector resize_default_init(n) + fill", none,
+        [n]
+        {
+          fast_vector<int> v;
+          v.resize_default_init(n);
+          for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i);
+          bench::doNotOptimize(v.data());
+        });
+  }
+  fmt::println("  (moved: 扩容时缓冲区地址改变的次数. std::vector 每次都复制全部元素; "
+               "realloc 原地扩展时不变, mremap 移动时只修改页表)");
+}
+
 int main()
 {
+  testFastVector();
+  benchFastVector();
+
   // 构造一个空的 vector
   std::vector<int> vec1;
   std::cout << "vec1 size: " << vec1.size() << ", capacity: " << vec1.capacity() << '\n';
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
+#include <variant>
+#include <vector>
+
+/// @brief 批处理的分块大小: 一块饮品的数据在四个步骤之间要能留在缓存中
+inline constexpr std::size_t kDrinkBatchTileSize = 256;
+
+/// @brief 批量制作饮品(虚函数版本)
+/// makeDrink() 逐个对象执行全部四个步骤(object-major), 不同类型的饮品交替出现时, 每一步都跳到不同的代码,
+/// 指令缓存和分支预测都很难命中. 这里先按具体类型分组, 再按步骤(stage-major)处理整组饮品:
+/// 同一组内每一步调用的都是同一个函数, 间接跳转的目标固定, 代码也一直留在缓存里.
+/// 整组饮品很多时按 kDrinkBatchTileSize 分块, 保证一块饮品在四个步骤之间仍留在数据缓存中.
+/// 能否比逐个制作更快取决于步骤本身的开销. DrinkBench 中每一步只有几条指令, 实测 DrinkBatch 并不比逐个
+/// 调用 makeDrink() 快(约 23 ns/drink 对 20~24 ns/drink), 分组省下的分支预测失败被多出的指针遍历抵消了.
+/// @tparam Base 饮品基类, 需要提供 Boil/Brew/PourInCup/PutSomething 四个步骤(例如 AbstractDrinking)
+template <typename Base>
+class DrinkBatch
+{
+public:
+  /// @brief 加入一杯饮品, 批处理对象只保存指针, 不负责其生命周期
+  void add(Base &drink)
+  {
+    const std::type_index type(typeid(drink));
+    for (auto &group : groups_)
+    {
+      if (group.type == type)
+      {
+        group.drinks.push_back(&drink);
+        return;
+      }
+    }
+    groups_.push_back(Group{type, {&drink}});
+  }
+
+  /// @brief 按 "类型 -> 分块 -> 步骤 -> 饮品" 的顺序制作整批饮品
+  void run()
+  {
+    for (auto &group : groups_)
+    {
+      Base *const *drinks = group.drinks.data();
+      const std::size_t count = group.drinks.size();
+      for (std::size_t begin = 0; begin < count; begin += kDrinkBatchTileSize)
+      {
+        const std::size_t end = begin + kDrinkBatchTileSize < count ? begin + kDrinkBatchTileSize : count;
+        for (std::size_t i = begin; i < end; ++i) drinks[i]->Boil();
+        for (std::size_t i = begin; i < end; ++i) drinks[i]->Brew();
+        for (std::size_t i = begin; i < end; ++i) drinks[i]->PourInCup();
+        for (std::size_t i = begin; i < end; ++i) drinks[i]->PutSomething();
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    std::size_t n = 0;
+    for (const auto &group : groups_) n += group.drinks.size();
+    return n;
+  }
+
+  void clear()
+  {
+    groups_.clear();
+  }
+
+private:
+  struct Group
+  {
+    std::type_index type;
+    std::vector<Base *> drinks;
+  };
+
+  std::vector<Group> groups_;  // 饮品种类很少, 线性查找即可
+};
+
+/// @brief 批量制作饮品(静态分派版本), 每种类型一个数组, 步骤调用可以被内联
+/// 数组里存放的是指针, 每一步都要经过一次间接访问. 对 std::variant 饮品, 它与逐个 std::visit 基本持平
+/// (DrinkBench 中约 9~10 ns/drink); 饮品本来就按类型连续存放时不要用它: CRTP 饮品经过这里比逐个制作
+/// 慢 2~2.6 倍(约 6.4 ns/drink 对 2.7 ns/drink), 应改用下面的 makeDrinksStageMajor
+/// @tparam Ts 饮品类型, 需要提供 Boil/Brew/PourInCup/PutSomething 四个步骤(例如 StaticCoffee, StaticTea)
+template <typename... Ts>
+class StaticDrinkBatch
+{
+public:
+  template <typename T>
+  void add(T &drink)
+  {
+    std::get<std::vector<T *>>(groups_).push_back(&drink);
+  }
+
+  /// @brief 从 variant 中取出具体类型后分组
+  void add(std::variant<Ts...> &drink)
+  {
+    std::visit(
+      [this](auto &d)
+      {
+        add(d);
+      },
+      drink);
+  }
+
+  void run()
+  {
+    std::apply(
+      [](auto &...groups)
+      {
+        (runGroup(groups), ...);
+      },
+      groups_);
+  }
+
+  void clear()
+  {
+    std::apply(
+      [](auto &...groups)
+      {
+        (groups.clear(), ...);
+      },
+      groups_);
+  }
+
+private:
+  template <typename T>
+  static void runGroup(std::vector<T *> &group)
+  {
+    T *const *drinks = group.data();
+    const std::size_t count = group.size();
+    for (std::size_t begin = 0; begin < count; begin += kDrinkBatchTileSize)
+    {
+      const std::size_t end = begin + kDrinkBatchTileSize < count ? begin + kDrinkBatchTileSize : count;
+      for (std::size_t i = begin; i < end; ++i) drinks[i]->Boil();
+      for (std::size_t i = begin; i < end; ++i) drinks[i]->Brew();
+      for (std::size_t i = begin; i < end; ++i) drinks[i]->PourInCup();
+      for (std::size_t i = begin; i < end; ++i) drinks[i]->PutSomething();
+    }
+  }
+
+  std::tuple<std::vector<Ts *>...> groups_;
+};
+
+/// @brief 连续存放的同一种饮品按步骤批量制作(stage-major). 与 StaticDrinkBatch 不同, 不经过指针数组,
+/// 步骤直接作用在数组元素上; 适合调用方本来就按类型分别保存饮品的情况(例如 std::vector<StaticCoffee>).
+/// 步骤很短时它仍然比逐个制作慢: DrinkBench 中约 3~11 ns/drink, 逐个制作约 2~3 ns/drink, 因为逐个制作时
+/// 编译器能把四个步骤内联合并成一次循环. 只有步骤本身足够重(代码放不进指令缓存)时按步骤处理才可能占优
+/// @tparam T 饮品类型, 需要提供 Boil/Brew/PourInCup/PutSomething 四个步骤
+template <typename T>
+void makeDrinksStageMajor(T *drinks, std::size_t count)
+{
+  for (std::size_t begin = 0; begin < count; begin += kDrinkBatchTileSize)
+  {
+    const std::size_t end = begin + kDrinkBatchTileSize < count ? begin + kDrinkBatchTileSize : count;
+    for (std::size_t i = begin; i < end; ++i) drinks[i].Boil();
+    for (std::size_t i = begin; i < end; ++i) drinks[i].Brew();
+    for (std::size_t i = begin; i < end; ++i) drinks[i].PourInCup();
+    for (std::size_t i = begin; i < end; ++i) drinks[i].PutSomething();
+  }
+}
@@ -0,0 +1,396 @@
+// 替换全局 operator new/delete 统计堆分配次数, 用来计算 "每杯饮品的分配次数"
+// 整个程序只能有一个文件定义这个宏, 而且要写在所有 #include 之前, 保证第一次包含 bench.hpp 时已经定义
+#define BENCH_COUNT_ALLOCATIONS
+
+#include "DrinkBench.h"
+
+#include <fmt/core.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <variant>
+#include <vector>
+
+#include "DrinkBatch.h"
+#include "DrinkPool.h"
+#include "StaticDrinking.h"
+#include "bench.hpp"
+
+namespace
+{
+/********************************* 测试用的饮品 *********************************/
+// 真实的 Coffee/Tea 每一步都会打印, 这里用不打印的配方代替, 三种分派方式共用同一份步骤实现,
+// 这样测到的差别只来自分派方式本身.
+
+struct DrinkState
+{
+  int water = 0;
+  int temperature = 0;
+  int cups = 0;
+  int extras = 0;
+};
+
+struct CoffeeRecipe
+{
+  static void Boil(DrinkState &s)
+  {
+    s.water += 250;
+    s.temperature = 95;
+  }
+  static void Brew(DrinkState &s)
+  {
+    s.water -= 20;
+  }
+  static void PourInCup(DrinkState &s)
+  {
+    ++s.cups;
+    s.temperature -= 5;
+  }
+  static void PutSomething(DrinkState &s)
+  {
+    s.extras += 2;
+  }
+};
+
+struct TeaRecipe
+{
+  static void Boil(DrinkState &s)
+  {
+    s.water += 300;
+    s.temperature = 100;
+  }
+  static void Brew(DrinkState &s)
+  {
+    s.water -= 10;
+    s.temperature -= 15;
+  }
+  static void PourInCup(DrinkState &s)
+  {
+    ++s.cups;
+  }
+  static void PutSomething(DrinkState &s)
+  {
+    s.extras += 1;
+  }
+};
+
+/// @brief 与 AbstractDrinking 相同结构的虚函数版本
+class VirtualDrink
+{
+public:
+  virtual void Boil() = 0;
+  virtual void Brew() = 0;
+  virtual void PourInCup() = 0;
+  virtual void PutSomething() = 0;
+  void makeDrink()
+  {
+    Boil();
+    Brew();
+    PourInCup();
+    PutSomething();
+  }
+  VirtualDrink() = default;
+  VirtualDrink(const VirtualDrink &) = default;
+  VirtualDrink &operator=(const VirtualDrink &) = default;
+  virtual ~VirtualDrink() = default;
+
+  DrinkState state;
+};
+
+template <typename Recipe>
+class VirtualDrinkOf : public VirtualDrink
+{
+public:
+  void Boil() override
+  {
+    Recipe::Boil(state);
+  }
+  void Brew() override
+  {
+    Recipe::Brew(state);
+  }
+  void PourInCup() override
+  {
+    Recipe::PourInCup(state);
+  }
+  void PutSomething() override
+  {
+    Recipe::PutSomething(state);
+  }
+};
+
+/// @brief CRTP 版本
+template <typename Recipe>
+class CrtpDrinkOf : public StaticDrinking<CrtpDrinkOf<Recipe>>
+{
+public:
+  void Boil()
+  {
+    Recipe::Boil(state);
+  }
+  void Brew()
+  {
+    Recipe::Brew(state);
+  }
+  void PourInCup()
+  {
+    Recipe::PourInCup(state);
+  }
+  void PutSomething()
+  {
+    Recipe::PutSomething(state);
+  }
+
+  DrinkState state;
+};
+
+using VirtualCoffee = VirtualDrinkOf<CoffeeRecipe>;
+using VirtualTea = VirtualDrinkOf<TeaRecipe>;
+using CrtpCoffee = CrtpDrinkOf<CoffeeRecipe>;
+using CrtpTea = CrtpDrinkOf<TeaRecipe>;
+using BenchVariant = std::variant<CrtpCoffee, CrtpTea>;
+
+int checksum(const DrinkState &s)
+{
+  return s.water + s.temperature + s.cups + s.extras;
+}
+
+/// @brief 生成咖啡和茶随机混合的订单, true 表示咖啡
+std::vector<bool> makeOrders(std::size_t count)
+{
+  std::mt19937 rng(42);
+  std::bernoulli_distribution coin(0.5);
+  std::vector<bool> orders(count);
+  for (std::size_t i = 0; i < count; ++i) orders[i] = coin(rng);
+  return orders;
+}
+
+/************************************ 测试 ************************************/
+
+/// @brief 同一批随机混合订单, 分别用三种方式保存
+struct Drinks
+{
+  std::vector<std::shared_ptr<VirtualDrink>> virtual_drinks;  // 和 mian.cpp 一样通过 shared_ptr<基类> 保存
+  std::vector<CrtpCoffee> coffees;                            // CRTP 没有公共基类, 不同类型只能放在各自的容器里
+  std::vector<CrtpTea> teas;
+  std::vector<BenchVariant> variant_drinks;  // variant 保留原有的混合顺序
+
+  explicit Drinks(const std::vector<bool> &orders)
+  {
+    virtual_drinks.reserve(orders.size());
+    variant_drinks.reserve(orders.size());
+    for (bool coffee : orders)
+    {
+      if (coffee)
+      {
+        virtual_drinks.push_back(std::make_shared<VirtualCoffee>());
+        coffees.emplace_back();
+        variant_drinks.emplace_back(std::in_place_type<CrtpCoffee>);
+      }
+      else
+      {
+        virtual_drinks.push_back(std::make_shared<VirtualTea>());
+        teas.emplace_back();
+        variant_drinks.emplace_back(std::in_place_type<CrtpTea>);
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    return virtual_drinks.size();
+  }
+};
+
+void benchDispatch(Drinks &drinks, int rounds)
+{
+  const std::size_t ops = drinks.size() * static_cast<std::size_t>(rounds);
+  fmt::println("-- 分派方式对比: {} 杯随机混合的饮品 x {} 轮", drinks.size(), rounds);
+
+  // 1. 虚函数: 每杯饮品 4 次虚函数调用
+  auto run_virtual = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+      for (auto &d : drinks.virtual_drinks) d->makeDrink();
+  };
+  bench::report("virtual (shared_ptr<base>)", bench::nsPerOp(ops, run_virtual), "ns/drink");
+
+  // 2. CRTP: 按类型分别遍历, 步骤全部内联
+  auto run_crtp = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+    {
+      for (auto &d : drinks.coffees) d.makeDrink();
+      for (auto &d : drinks.teas) d.makeDrink();
+    }
+  };
+  bench::report("CRTP (one vector per type)", bench::nsPerOp(ops, run_crtp), "ns/drink");
+
+  // 3. std::variant: 每杯饮品一次 visit
+  auto run_variant = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+      for (auto &d : drinks.variant_drinks) makeDrink(d);
+  };
+  bench::report("std::variant + visit (mixed order)", bench::nsPerOp(ops, run_variant), "ns/drink");
+}
+
+void benchBatch(Drinks &drinks, int rounds)
+{
+  const std::size_t ops = drinks.size() * static_cast<std::size_t>(rounds);
+  fmt::println("-- 逐个制作(object-major)与批量制作(stage-major)对比:");
+
+  auto run_per_object = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+      for (auto &d : drinks.virtual_drinks) d->makeDrink();
+  };
+  bench::report("virtual, per-object makeDrink", bench::nsPerOp(ops, run_per_object), "ns/drink");
+
+  DrinkBatch<VirtualDrink> batch;
+  auto build_batch = [&]
+  {
+    for (auto &d : drinks.virtual_drinks) batch.add(*d);
+  };
+  bench::report("virtual, DrinkBatch grouping (once)", bench::nsPerOp(drinks.size(), build_batch), "ns/drink");
+  auto run_batch = [&]
+  {
+    for (int r = 0; r < rounds; ++r) batch.run();
+  };
+  bench::report("virtual, DrinkBatch stage-major", bench::nsPerOp(ops, run_batch), "ns/drink");
+
+  auto run_variant = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+      for (auto &d : drinks.variant_drinks) makeDrink(d);
+  };
+  bench::report("variant, per-object makeDrink", bench::nsPerOp(ops, run_variant), "ns/drink");
+
+  StaticDrinkBatch<CrtpCoffee, CrtpTea> static_batch;
+  for (auto &d : drinks.variant_drinks) static_batch.add(d);
+  auto run_static_batch = [&]
+  {
+    for (int r = 0; r < rounds; ++r) static_batch.run();
+  };
+  bench::report("variant, StaticDrinkBatch stage-major", bench::nsPerOp(ops, run_static_batch), "ns/drink");
+
+  // CRTP 也跑同样的两遍, 三种保存方式的制作轮数保持一致, 之后仍然可以比较 checksum
+  auto run_crtp = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+    {
+      for (auto &d : drinks.coffees) d.makeDrink();
+      for (auto &d : drinks.teas) d.makeDrink();
+    }
+  };
+  bench::report("CRTP, per-type makeDrink", bench::nsPerOp(ops, run_crtp), "ns/drink");
+
+  // CRTP 饮品本来就按类型连续存放, 直接在数组上按步骤制作, 不经过 StaticDrinkBatch 的指针数组
+  auto run_crtp_batch = [&]
+  {
+    for (int r = 0; r < rounds; ++r)
+    {
+      makeDrinksStageMajor(drinks.coffees.data(), drinks.coffees.size());
+      makeDrinksStageMajor(drinks.teas.data(), drinks.teas.size());
+    }
+  };
+  bench::report("CRTP, contiguous stage-major", bench::nsPerOp(ops, run_crtp_batch), "ns/drink");
+}
+
+BENCH_NOINLINE void doWorkByValue(std::shared_ptr<VirtualDrink> drink)  // NOLINT(performance-unnecessary-value-param)
+{
+  drink->makeDrink();
+}
+
+BENCH_NOINLINE void doWorkByRef(VirtualDrink &drink)
+{
+  drink.makeDrink();
+}
+
+void benchOwnership(Drinks &drinks, const std::vector<bool> &orders)
+{
+  const std::size_t count = drinks.size();
+  fmt::println("-- doWork 传参方式与饮品创建方式对比:");
+
+  // 1. 只看传参: 按值传 shared_ptr 每次调用一次原子加和一次原子减
+  auto by_value = [&]
+  {
+    for (auto &d : drinks.virtual_drinks) doWorkByValue(d);
+  };
+  bench::report("doWork(shared_ptr) by value", bench::nsPerOp(count, by_value), "ns/drink");
+  auto by_ref = [&]
+  {
+    for (auto &d : drinks.virtual_drinks) doWorkByRef(*d);
+  };
+  bench::report("doWork(AbstractDrinking &)", bench::nsPerOp(count, by_ref), "ns/drink");
+
+  // 2. 完整生命周期: 创建 -> 制作 -> 销毁
+  std::size_t before = bench::allocationCount();
+  auto shared_lifecycle = [&]
+  {
+    for (bool coffee : orders)
+    {
+      std::shared_ptr<VirtualDrink> d;
+      if (coffee)
+        d = std::make_shared<VirtualCoffee>();
+      else
+        d = std::make_shared<VirtualTea>();
+      doWorkByValue(d);
+    }
+  };
+  bench::report("make_shared + doWork(shared_ptr)", bench::nsPerOp(count, shared_lifecycle), "ns/drink");
+  const double shared_allocs = static_cast<double>(bench::allocationCount() - before) / static_cast<double>(count);
+
+  DrinkPool<VirtualDrink, VirtualCoffee, VirtualTea> pool;
+  before = bench::allocationCount();
+  auto pooled_lifecycle = [&]
+  {
+    for (bool coffee : orders)
+    {
+      auto d = coffee ? pool.make<VirtualCoffee>() : pool.make<VirtualTea>();
+      doWorkByRef(*d);
+    }
+  };
+  bench::report("DrinkPool::make + doWork(&)", bench::nsPerOp(count, pooled_lifecycle), "ns/drink");
+  const double pooled_allocs = static_cast<double>(bench::allocationCount() - before) / static_cast<double>(count);
+
+  fmt::println("  allocations per drink: make_shared = {:.3f}, DrinkPool = {:.6f} ({} chunk)", shared_allocs,
+               pooled_allocs, pool.chunkCount());
+}
+
+/// @brief 三种保存方式的制作结果必须一致, 不一致时说明某个测试少做或多做了饮品, 后面的数字没有意义, 直接退出
+void verify(const Drinks &drinks)
+{
+  long long sum_virtual = 0, sum_crtp = 0, sum_variant = 0;
+  for (auto &d : drinks.virtual_drinks) sum_virtual += checksum(d->state);
+  for (auto &d : drinks.coffees) sum_crtp += checksum(d.state);
+  for (auto &d : drinks.teas) sum_crtp += checksum(d.state);
+  for (auto &v : drinks.variant_drinks)
+    std::visit(
+      [&](auto &d)
+      {
+        sum_variant += checksum(d.state);
+      },
+      v);
+  const bool same = sum_virtual == sum_crtp && sum_virtual == sum_variant;
+  fmt::println("  checksum: virtual = {}, CRTP = {}, variant = {} -> {}", sum_virtual, sum_crtp, sum_variant,
+               same ? "OK" : "MISMATCH");
+  if (!same) std::exit(EXIT_FAILURE);
+}
+}  // namespace
+
+void runDrinkBenchmarks()
+{
+  constexpr std::size_t kDrinks = 1'000'000;
+  constexpr int kRounds = 10;
+  fmt::println("========== benchmark: makeDrink ==========");
+  auto orders = makeOrders(kDrinks);
+  Drinks drinks(orders);
+  benchDispatch(drinks, kRounds);
+  verify(drinks);
+  benchBatch(drinks, kRounds);
+  verify(drinks);
+  benchOwnership(drinks, orders);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+/// @brief 饮料制作流程的性能测试: 虚函数 / CRTP / std::variant 三种分派方式
+void runDrinkBenchmarks();
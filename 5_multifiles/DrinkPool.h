@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// @brief 饮品对象池: 为一组饮品类型提供统一大小的槽位, 用空闲链表回收, 避免每杯饮品一次堆分配.
+/// 返回的是独占所有权的 unique_ptr, 没有引用计数开销; 析构时通过虚析构函数销毁对象, 再把槽位还给对象池.
+/// 对象池不是线程安全的, 且必须比它创建的所有对象活得更久.
+/// @tparam Base 饮品基类, 必须有虚析构函数(例如 AbstractDrinking)
+/// @tparam Ts 可以在池中创建的具体饮品类型
+template <typename Base, typename... Ts>
+class DrinkPool
+{
+  static_assert(std::has_virtual_destructor_v<Base>, "Base 需要虚析构函数");
+  static_assert((std::is_base_of_v<Base, Ts> && ...), "Ts 必须派生自 Base");
+
+public:
+  /// @brief 删除器: 只保存对象池指针, unique_ptr 仍然只比裸指针多 8 字节
+  struct Deleter
+  {
+    DrinkPool *pool = nullptr;
+    void operator()(Base *drink) const noexcept
+    {
+      pool->destroy(drink);
+    }
+  };
+  using Ptr = std::unique_ptr<Base, Deleter>;
+
+  explicit DrinkPool(std::size_t slots_per_chunk = 1024) : slots_per_chunk_(slots_per_chunk) {}
+  DrinkPool(const DrinkPool &) = delete;
+  DrinkPool &operator=(const DrinkPool &) = delete;
+  ~DrinkPool()
+  {
+    for (void *chunk : chunks_) ::operator delete(chunk, std::align_val_t{kSlotAlign});
+  }
+
+  /// @brief 在池中构造一杯饮品
+  template <typename T, typename... Args>
+  Ptr make(Args &&...args)
+  {
+    static_assert((std::is_same_v<T, Ts> || ...), "T 不在对象池支持的类型列表中");
+    void *slot = acquire();
+    try
+    {
+      T *drink = ::new (slot) T(std::forward<Args>(args)...);
+      return Ptr(drink, Deleter{this});
+    }
+    catch (...)
+    {
+      release(slot);
+      throw;
+    }
+  }
+
+  /// @brief 向系统申请过的内存块数量(每块 slots_per_chunk 个槽位)
+  [[nodiscard]] std::size_t chunkCount() const
+  {
+    return chunks_.size();
+  }
+
+private:
+  static constexpr std::size_t kSlotSize = std::max({sizeof(void *), sizeof(Ts)...});
+  static constexpr std::size_t kSlotAlign = std::max({alignof(void *), alignof(Ts)...});
+  static constexpr std::size_t kStride = (kSlotSize + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+
+  // 空闲槽位的前几个字节用来保存下一个空闲槽位的地址
+  struct FreeSlot
+  {
+    FreeSlot *next;
+  };
+
+  void *acquire()
+  {
+    if (free_ == nullptr) grow();
+    FreeSlot *slot = free_;
+    free_ = slot->next;
+    return slot;
+  }
+
+  void release(void *slot) noexcept
+  {
+    free_ = ::new (slot) FreeSlot{free_};
+  }
+
+  void destroy(Base *drink) noexcept
+  {
+    // dynamic_cast<void *> 得到完整对象的起始地址, 也就是槽位地址
+    void *slot = dynamic_cast<void *>(drink);
+    drink->~Base();
+    release(slot);
+  }
+
+  void grow()
+  {
+    chunks_.reserve(chunks_.size() + 1);  // 先保证 push_back 不会抛异常, 避免内存块泄漏
+    auto *chunk = static_cast<std::byte *>(::operator new(kStride * slots_per_chunk_, std::align_val_t{kSlotAlign}));
+    chunks_.push_back(chunk);
+    for (std::size_t i = slots_per_chunk_; i > 0; --i) release(chunk + (i - 1) * kStride);
+  }
+
+  std::size_t slots_per_chunk_;
+  std::vector<void *> chunks_;
+  FreeSlot *free_ = nullptr;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <fmt/core.h>
+
+#include <variant>
+
+/// @brief 饮料的静态多态(CRTP)版本, 与 AbstractDrinking 接口相同, 但步骤在编译期确定, 没有虚函数调用
+/// @tparam Derived 具体饮品类型, 需要提供 Boil/Brew/PourInCup/PutSomething 四个步骤
+template <typename Derived>
+class StaticDrinking
+{
+public:
+  // 制作流程: 静态分派到 Derived 的步骤, 可以被编译器内联
+  void makeDrink()
+  {
+    Derived &self = static_cast<Derived &>(*this);
+    self.Boil();
+    self.Brew();
+    self.PourInCup();
+    self.PutSomething();
+  }
+
+private:
+  // 只允许 Derived 继承, 防止 class Tea : StaticDrinking<Coffee> 这类误用
+  StaticDrinking() = default;
+  friend Derived;
+};
+
+/// @brief 咖啡饮品(CRTP)
+class StaticCoffee : public StaticDrinking<StaticCoffee>
+{
+public:
+  // 烧水
+  void Boil()
+  {
+    fmt::println("1.煮农夫山泉水");
+  }
+  // 冲泡
+  void Brew()
+  {
+    fmt::println("2.冲泡咖啡");
+  }
+  // 倒入杯中
+  void PourInCup()
+  {
+    fmt::println("3.倒入咖啡杯中");
+  }
+  // 加入辅料
+  void PutSomething()
+  {
+    fmt::println("4.添加猫屎");
+  }
+};
+
+/// @brief 茶饮品(CRTP)
+class StaticTea : public StaticDrinking<StaticTea>
+{
+public:
+  // 烧水
+  void Boil()
+  {
+    fmt::println("1.煮开水");
+  }
+  // 冲泡
+  void Brew()
+  {
+    fmt::println("2.冲泡茶叶");
+  }
+  // 倒入杯中
+  void PourInCup()
+  {
+    fmt::println("3.倒入保温杯中");
+  }
+  // 加入辅料
+  void PutSomething()
+  {
+    fmt::println("4.添加枸杞");
+  }
+};
+
+/// @brief 封闭的饮品集合, 用 std::variant 代替基类指针, 不需要堆分配
+using DrinkVariant = std::variant<StaticCoffee, StaticTea>;
+
+/// @brief variant 版本的制作流程: 一次 visit 分派到具体类型, 之后四个步骤都是静态调用
+/// @tparam Ts 饮品类型, 都需要继承 StaticDrinking
+template <typename... Ts>
+void makeDrink(std::variant<Ts...> &drink)
+{
+  std::visit(
+    [](auto &d)
+    {
+      d.makeDrink();
+    },
+    drink);
+}
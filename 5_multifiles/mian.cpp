@@ -4,25 +4,65 @@
 #include <fmt/core.h>
 #include "AbstractDrinking.h"
 #include "Coffee.h"
+#include "DrinkBatch.h"
+#include "DrinkBench.h"
+#include "DrinkPool.h"
+#include "StaticDrinking.h"
 #include "Tea.h"
 
-void doWork(std::shared_ptr<AbstractDrinking> drink)
+// 只使用饮品, 不参与所有权管理, 传引用即可. 按值传 shared_ptr 每次调用都有一次原子加和一次原子减
+void doWork(AbstractDrinking &drink)
 {
-  drink->makeDrink();
+  drink.makeDrink();
 }
 
 void makeCoffee()
 {
   fmt::println("======= 制作咖啡饮料:");
   std::shared_ptr<AbstractDrinking> coffee = std::make_shared<Coffee>();
-  doWork(coffee);
+  doWork(*coffee);
 }
 
 void makeTea()
 {
   fmt::println("======= 制作茶饮料:");
   auto tea = std::make_shared<Tea>();
-  doWork(tea);
+  doWork(*tea);
+}
+
+void makeStaticDrinks()
+{
+  fmt::println("======= 静态分派(CRTP)制作咖啡饮料:");
+  StaticCoffee coffee;
+  coffee.makeDrink();
+  fmt::println("======= 静态分派(std::variant)制作茶饮料:");
+  DrinkVariant tea = StaticTea{};
+  makeDrink(tea);
+}
+
+void makeDrinkBatch()
+{
+  fmt::println("======= 批量制作饮料(按类型分组, 每个步骤处理整组):");
+  Coffee coffee1;
+  Tea tea;
+  Coffee coffee2;
+  DrinkBatch<AbstractDrinking> batch;
+  batch.add(coffee1);
+  batch.add(tea);
+  batch.add(coffee2);
+  batch.run();
+}
+
+void makeDrinkFromPool()
+{
+  fmt::println("======= 从对象池制作饮料(独占所有权, 槽位复用):");
+  DrinkPool<AbstractDrinking, Coffee, Tea> pool;
+  {
+    auto coffee = pool.make<Coffee>();
+    doWork(*coffee);
+  }
+  auto tea = pool.make<Tea>();  // 复用刚才咖啡释放的槽位
+  doWork(*tea);
 }
 
 auto main(int argc, char **argv) -> int
@@ -34,4 +74,11 @@ auto main(int argc, char **argv) -> int
   fmt::println("---------------------------------");
   makeTea();
   fmt::println("---------------------------------");
+  makeStaticDrinks();
+  fmt::println("---------------------------------");
+  makeDrinkBatch();
+  fmt::println("---------------------------------");
+  makeDrinkFromPool();
+  fmt::println("---------------------------------");
+  runDrinkBenchmarks();
 }
\ No newline at end of file
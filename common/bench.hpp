@@ -0,0 +1,100 @@
+#pragma once
+#include <fmt/core.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+#if defined(BENCH_COUNT_ALLOCATIONS)
+#include <cstdlib>
+#include <new>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_NOINLINE __declspec(noinline)
+#elif defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+// GCC 即使不内联也会针对常量实参克隆函数(IPA-CP), noclone 保证测到的是真正的间接调用
+#define BENCH_NOINLINE __attribute__((noinline, noclone))
+#endif
+
+/**
+ * 简易微基准测试工具, 各个示例目录通过 CMake 的 common 目标共用.
+ * 计时使用 steady_clock, 结果以 "纳秒/次" 输出, 只适合做同一台机器上的相对比较.
+ *
+ * 分配计数是可选的: 在程序中 "一个" .cpp 文件里先 #define BENCH_COUNT_ALLOCATIONS 再包含本文件,
+ * 这个文件就会替换全局的 operator new / delete, 之后 bench::allocationCount() 返回整个程序到目前为止的堆分配次数.
+ * 没有定义这个宏的程序不受影响, allocationCount() 始终为 0.
+ */
+namespace bench
+{
+/// @brief 阻止编译器把基准测试中的计算结果优化掉
+/// @tparam T 任意类型
+/// @param value 需要"被使用"的值
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static const volatile void *sink = nullptr;
+  sink = &value;
+  _ReadWriteBarrier();
+#endif
+}
+
+/// @brief 运行一次 body 并返回平均每次操作的耗时(ns)
+/// @tparam F 可调用对象类型, 内部自己完成 ops 次循环
+/// @param ops body 内部执行的操作次数
+/// @param body 被测代码
+/// @return 纳秒/次
+template <typename F>
+double nsPerOp(std::size_t ops, F &&body)
+{
+  auto start = std::chrono::steady_clock::now();
+  body();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(ops);
+}
+
+namespace detail
+{
+inline std::atomic<std::size_t> g_allocations{0};
+}
+
+/// @brief 到目前为止的堆分配次数, 只有定义了 BENCH_COUNT_ALLOCATIONS 的程序才会计数
+inline std::size_t allocationCount() noexcept
+{
+  return detail::g_allocations.load(std::memory_order_relaxed);
+}
+
+/// @brief 打印一行测试结果
+/// @param unit 单位, 默认 "ns/op", 也可以换成更具体的说法, 例如 "ns/drink"
+inline void report(std::string_view name, double ns, std::string_view unit = "ns/op")
+{
+  fmt::println("  {:<40} {:>8.3f} {}", name, ns, unit);
+}
+}  // namespace bench
+
+#if defined(BENCH_COUNT_ALLOCATIONS)
+// 数组版本和 nothrow 版本的默认实现都会转调这两个函数
+void *operator new(std::size_t size)
+{
+  bench::detail::g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t /*size*/) noexcept
+{
+  std::free(p);
+}
+#endif